@@ -1,4 +1,8 @@
-QT       += core gui widgets
-TARGET = MedicalStore
-TEMPLATE = app
-SOURCES += main.cpp
+TEMPLATE = subdirs
+SUBDIRS = core app cli server bench tests
+
+app.depends = core
+cli.depends = core
+server.depends = core
+bench.depends = core
+tests.depends = core
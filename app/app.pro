@@ -0,0 +1,10 @@
+QT       += core gui widgets
+TARGET = MedicalStore
+TEMPLATE = app
+SOURCES += main.cpp \
+           dashboarddialog.cpp \
+           medicinetablemodel.cpp
+HEADERS += dashboarddialog.h \
+           medicinetablemodel.h
+
+include(../core/core.pri)
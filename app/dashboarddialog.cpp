@@ -0,0 +1,102 @@
+#include "dashboarddialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+
+static QTableWidget *createTable(const QStringList &labels) {
+    QTableWidget *table = new QTableWidget(0, labels.size());
+    table->setHorizontalHeaderLabels(labels);
+    table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    return table;
+}
+
+static void setRow(QTableWidget *table, int row, const QString &label, const InventoryAnalytics::StockTotals &t, qint64 totalPaisa) {
+    const QStringList cells = {label, QString::number(t.items), QString::number(t.units), formatRupees(t.valuePaisa),
+                               QString::number(totalPaisa > 0 ? 100.0 * t.valuePaisa / totalPaisa : 0.0, 'f', 1) + "%"};
+    for(int c=0; c<cells.size(); ++c) {
+        QTableWidgetItem *item = new QTableWidgetItem(cells[c]);
+        if(c > 0) item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        table->setItem(row, c, item);
+    }
+}
+
+// --- STOCK DASHBOARD ---
+DashboardDialog::DashboardDialog(InventoryAnalytics &analytics, QWidget *parent) : QDialog(parent), analytics(analytics) {
+    setWindowTitle("Stock Dashboard");
+    resize(720, 640);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *totals = new QHBoxLayout();
+    lblValue = new QLabel();
+    lblUnits = new QLabel();
+    lblSkus = new QLabel();
+    for(QLabel *lbl : {lblValue, lblUnits, lblSkus}) {
+        lbl->setStyleSheet("font-size: 18px; font-weight: bold; color: #0066CC;");
+        totals->addWidget(lbl);
+    }
+    layout->addLayout(totals);
+
+    layout->addWidget(new QLabel("Stock value by company"));
+    tableCompanies = createTable({"Company", "SKUs", "Units", "Value (Rs)", "Share"});
+    layout->addWidget(tableCompanies, 3);
+
+    layout->addWidget(new QLabel("Stock aging by expiry"));
+    tableAging = createTable({"Expires", "Lots", "Units", "Value (Rs)", "Share"});
+    layout->addWidget(tableAging, 2);
+
+    lblStatus = new QLabel();
+    lblStatus->setStyleSheet("color: #555555; font-size: 12px;");
+    layout->addWidget(lblStatus);
+
+    connect(&analytics, &InventoryAnalytics::updated, this, &DashboardDialog::showReport);
+}
+
+void DashboardDialog::showEvent(QShowEvent *event) {
+    QDialog::showEvent(event);
+    showReport();
+    analytics.setAutoRefresh(300);
+    if(analytics.isStale()) analytics.refresh();
+}
+
+void DashboardDialog::hideEvent(QHideEvent *event) {
+    analytics.setAutoRefresh(0);
+    QDialog::hideEvent(event);
+}
+
+void DashboardDialog::showReport() {
+    const InventoryAnalytics::Report &r = analytics.report();
+    lblValue->setText("Value: Rs " + formatRupees(r.total.valuePaisa));
+    lblUnits->setText("Units: " + QString::number(r.total.units));
+    lblSkus->setText("SKUs: " + QString::number(r.total.items));
+
+    const int listed = qMin(TOP_COMPANIES, int(r.byCompany.size()));
+    const bool others = r.byCompany.size() > listed;
+    tableCompanies->setRowCount(listed + (others ? 1 : 0));
+    InventoryAnalytics::StockTotals rest;
+    for(int i=0; i<r.byCompany.size(); ++i) {
+        const auto &c = r.byCompany[i];
+        if(i < listed) {
+            setRow(tableCompanies, i, c.company.isEmpty() ? QString("(no company)") : c.company, c.totals, r.total.valuePaisa);
+            continue;
+        }
+        rest.valuePaisa += c.totals.valuePaisa;
+        rest.units += c.totals.units;
+        rest.items += c.totals.items;
+    }
+    if(others) setRow(tableCompanies, listed, QString("(%1 other companies)").arg(r.byCompany.size() - listed), rest, r.total.valuePaisa);
+
+    tableAging->setRowCount(InventoryAnalytics::AgeBucketCount);
+    for(int a=0; a<InventoryAnalytics::AgeBucketCount; ++a) {
+        setRow(tableAging, a, InventoryAnalytics::bucketLabel(InventoryAnalytics::AgeBucket(a)), r.aging[a], r.total.valuePaisa);
+    }
+
+    if(!r.asOf.isValid()) lblStatus->setText("Calculating...");
+    else lblStatus->setText(QString("As of %1. Refreshed in %2 ms (%3 of %4 blocks recomputed)%5")
+                                .arg(r.asOf.toString("yyyy-MM-dd")).arg(r.elapsedNs / 1e6, 0, 'f', 1)
+                                .arg(r.blocksComputed).arg(r.blockCount).arg(analytics.isStale() ? QString(", updating...") : QString()));
+}
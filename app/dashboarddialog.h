@@ -0,0 +1,36 @@
+#ifndef DASHBOARDDIALOG_H
+#define DASHBOARDDIALOG_H
+
+#include <QDialog>
+#include "inventoryanalytics.h"
+
+class QLabel;
+class QTableWidget;
+
+// --- STOCK DASHBOARD ---
+// Stock value, the per-company rollup and expiry aging from
+// InventoryAnalytics. While the dialog is open the analytics refresh on
+// their own shortly after each change, recomputing only the blocks the
+// change touched.
+class DashboardDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit DashboardDialog(InventoryAnalytics &analytics, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    // Companies listed by name; the rest are summed into one row
+    static const int TOP_COMPANIES = 50;
+
+    InventoryAnalytics &analytics;
+    QLabel *lblValue, *lblUnits, *lblSkus, *lblStatus;
+    QTableWidget *tableCompanies, *tableAging;
+
+    void showReport();
+};
+
+#endif // DASHBOARDDIALOG_H
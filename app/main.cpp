@@ -0,0 +1,1125 @@
+#include <QApplication>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTableView>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QInputDialog>
+#include <QGroupBox>
+#include <QFile>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDialog>
+#include <QTextEdit>
+#include <QStyleFactory>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QCheckBox>
+#include <QShortcut>
+#include <QFileDialog>
+#include <QCommandLineParser>
+#include <QPointer>
+
+#include "storecore.h"
+#include "medicinetablemodel.h"
+#include "searchindex.h"
+#include "backupengine.h"
+#include "profiler.h"
+#include "inventoryanalytics.h"
+#include "dashboarddialog.h"
+#include "receiptspooler.h"
+
+class MedicalStore : public QWidget {
+    Q_OBJECT
+
+private:
+    StoreCore core;
+    const InventoryStore &inventory{core.inventory()};
+    const QString BACKUP_DIR = "backups";
+
+    QLineEdit *txtId, *txtName, *txtPrice, *txtStock, *txtExpiry, *txtCompany, *txtReorder;
+    QLineEdit *txtSearch;
+    QLineEdit *txtScan;
+    QTableView *tableMedicines;
+    QTableWidget *tableCart;
+    MedicineTableModel *modelMedicines;
+
+    // --- SEARCH ---
+    QThread searchThread;
+    SearchEngine *searchEngine;
+    QTimer *searchTimer;
+    quint64 searchTicket = 0;
+
+    // --- BACKUP ---
+    QThread backupThread;
+    BackupEngine *backupEngine;
+    // Journals held for queued backups, oldest first; the backup thread
+    // finishes them in order
+    QList<QPointer<InventoryJournal>> heldJournals;
+    QLabel *lblBackup;
+    QLabel *lblTotal;
+    QPushButton *btnResume;
+
+    // --- STARTUP ---
+    QElapsedTimer startupTimer;
+    qint64 uiReadyMs = -1;
+    qint64 dataReadyMs = -1;
+    bool writeFailureShown = false;
+
+    // --- SCAN ---
+    QStringList scanQueue;
+    QLabel *lblScan;
+
+    // --- ANALYTICS ---
+    InventoryAnalytics *analytics;
+    DashboardDialog *dlgDashboard = nullptr;
+
+    // --- RECEIPTS ---
+    QThread spoolThread;
+    ReceiptSpooler *spooler;
+    ReceiptTemplate receiptLayout;
+    QByteArray receiptText;
+    QDialog *dlgReceipt = nullptr;
+    QTextEdit *txtReceipt;
+    // Where every checkout is printed; empty prints nothing
+    QString printDestination;
+    ReceiptSpooler::Format printFormat = ReceiptSpooler::PlainText;
+
+    // --- DIAGNOSTICS ---
+    QDialog *dlgDiagnostics = nullptr;
+    QTextEdit *txtDiagnostics;
+    QTimer *diagnosticsTimer;
+
+    // --- COLORS ---
+    QString primaryColor = "#0066CC"; // Medical Blue
+    QString successColor = "#28A745"; // Green
+    QString dangerColor  = "#DC3545"; // Red
+    QString warningColor = "#FFC107"; // Orange
+
+    // --- STYLESHEET ---
+    QString appStyle =
+        "QWidget { font-family: 'Segoe UI', sans-serif; font-size: 14px; }"
+        "QWidget#CentralWidget { background-color: #F0F4F8; }"
+
+        // Input Fields
+        "QLineEdit { color: #333333; background-color: white; border: 1px solid #BDC3C7; padding: 6px; border-radius: 4px; }"
+        "QLineEdit:focus { border: 2px solid #0066CC; }"
+
+        // Tables
+        "QTableView { background-color: white; color: #333333; gridline-color: #E0E0E0; border: 1px solid #BDC3C7; }"
+        "QHeaderView::section { background-color: #E8E8E8; color: #333333; padding: 6px; border: none; font-weight: bold; }"
+        "QTableView::item:selected { background-color: #0066CC; color: white; }"
+
+        "QDialog, QMessageBox, QInputDialog { background-color: white; color: #333333; }"
+        "QDialog QLabel { color: #333333; font-weight: bold; }"
+
+        "QDialog QPushButton { background-color: #0066CC; color: white; padding: 6px 15px; border-radius: 4px; min-width: 60px; }"
+        "QDialog QPushButton:hover { background-color: #0055AA; }"
+
+        "QPushButton { color: white; font-weight: bold; padding: 8px 16px; border-radius: 4px; border: none; }"
+        "QPushButton:hover { margin-top: -1px; margin-bottom: 1px; }";
+
+public:
+    MedicalStore(QWidget *parent = nullptr) : QWidget(parent) {
+        setObjectName("CentralWidget");
+        setWindowTitle("Medical Store Management System - Professional Edition");
+        resize(1300, 800);
+        setStyleSheet(appStyle);
+
+        // 1. SECURE LOGIN
+        bool ok;
+        QString text = QInputDialog::getText(nullptr, "Security Check", "Enter Admin Password:", QLineEdit::Password, "", &ok);
+        if (!ok || text != "admin123") {
+            QMessageBox::critical(nullptr, "Access Denied", "Incorrect Password.");
+            exit(0);
+        }
+
+        // 2. STARTUP PIPELINE
+        // The catalogue loads on a worker thread while the window is built
+        // and shown; rows stream in, then search and the auto backup start.
+        startupTimer.start();
+        connect(&core, &StoreCore::opened, this, &MedicalStore::onDataLoaded);
+        connect(&core, &StoreCore::writeFailed, this, &MedicalStore::onWriteFailed);
+        core.openAsync();
+        setupBackup();
+        setupSearch();
+        setupSpooler();
+        analytics = new InventoryAnalytics(core, this);
+
+        // --- LAYOUT SETUP ---
+        QVBoxLayout *mainLayout = new QVBoxLayout(this);
+        mainLayout->setContentsMargins(0, 0, 0, 0);
+
+        // --- HEADER ---
+        QWidget *header = new QWidget();
+        header->setStyleSheet("background-color: " + primaryColor + ";");
+        header->setFixedHeight(80);
+        QHBoxLayout *headerLayout = new QHBoxLayout(header);
+
+        QLabel *title = new QLabel("Medical Store System");
+        title->setStyleSheet("color: white; font-size: 28px; font-weight: bold; background: transparent; padding-left: 10px;");
+
+        QPushButton *btnBackup = new QPushButton("Backup Data");
+        btnBackup->setStyleSheet("background-color: white; color: " + primaryColor + "; font-weight: bold;");
+        connect(btnBackup, &QPushButton::clicked, this, [=]() { createBackup("Manual"); });
+
+        QPushButton *btnRestore = new QPushButton("Restore");
+        btnRestore->setStyleSheet(btnBackup->styleSheet());
+        connect(btnRestore, &QPushButton::clicked, this, &MedicalStore::restoreBackup);
+
+        QPushButton *btnReport = new QPushButton("Sales Report");
+        btnReport->setStyleSheet(btnBackup->styleSheet());
+        connect(btnReport, &QPushButton::clicked, this, &MedicalStore::showSalesReport);
+
+        QPushButton *btnExpiring = new QPushButton("Expiring Soon");
+        btnExpiring->setStyleSheet(btnBackup->styleSheet());
+        connect(btnExpiring, &QPushButton::clicked, this, &MedicalStore::showExpiringReport);
+
+        QPushButton *btnDashboard = new QPushButton("Dashboard");
+        btnDashboard->setStyleSheet(btnBackup->styleSheet());
+        connect(btnDashboard, &QPushButton::clicked, this, &MedicalStore::showDashboard);
+
+        QPushButton *btnReorder = new QPushButton("Reorder Report");
+        btnReorder->setStyleSheet(btnBackup->styleSheet());
+        connect(btnReorder, &QPushButton::clicked, this, &MedicalStore::showReorderReport);
+
+        QPushButton *btnReprint = new QPushButton("Reprint");
+        btnReprint->setStyleSheet(btnBackup->styleSheet());
+        connect(btnReprint, &QPushButton::clicked, this, &MedicalStore::reprintReceipt);
+
+        QPushButton *btnExportReceipts = new QPushButton("Export Receipts");
+        btnExportReceipts->setStyleSheet(btnBackup->styleSheet());
+        connect(btnExportReceipts, &QPushButton::clicked, this, &MedicalStore::exportReceipts);
+
+        lblBackup = new QLabel("Loading inventory...");
+        lblBackup->setStyleSheet("color: white; background: transparent; padding-right: 10px;");
+
+        headerLayout->addWidget(title);
+        headerLayout->addStretch();
+        headerLayout->addWidget(lblBackup);
+        headerLayout->addWidget(btnDashboard);
+        headerLayout->addWidget(btnReport);
+        headerLayout->addWidget(btnExpiring);
+        headerLayout->addWidget(btnReorder);
+        headerLayout->addWidget(btnReprint);
+        headerLayout->addWidget(btnExportReceipts);
+        headerLayout->addWidget(btnBackup);
+        headerLayout->addWidget(btnRestore);
+        headerLayout->setContentsMargins(20, 0, 20, 0);
+        mainLayout->addWidget(header);
+
+        // --- MAIN CONTENT AREA ---
+        QHBoxLayout *contentLayout = new QHBoxLayout();
+        contentLayout->setContentsMargins(15, 15, 15, 15);
+        contentLayout->setSpacing(15);
+
+        // 1. LEFT PANEL (Inputs)
+        QGroupBox *grpInput = new QGroupBox("Medicine Details");
+        grpInput->setStyleSheet("QGroupBox { font-weight: bold; color: #333333; border: 1px solid #BDC3C7; border-radius: 6px; margin-top: 10px; background-color: white; } "
+                                "QGroupBox::title { subcontrol-origin: margin; left: 10px; padding: 0 5px; }");
+        grpInput->setFixedWidth(350);
+        QVBoxLayout *leftLayout = new QVBoxLayout(grpInput);
+
+        QGridLayout *formLayout = new QGridLayout();
+        formLayout->setVerticalSpacing(15);
+        txtId = createInput(formLayout, 0, "ID (Int):");
+        txtName = createInput(formLayout, 1, "Name:");
+        txtPrice = createInput(formLayout, 2, "Price:");
+        txtStock = createInput(formLayout, 3, "Stock:");
+        txtExpiry = createInput(formLayout, 4, "Expiry:");
+        txtExpiry->setPlaceholderText("yyyy-MM-dd");
+        txtCompany = createInput(formLayout, 5, "Company:");
+        txtReorder = createInput(formLayout, 6, "Reorder at:");
+        txtReorder->setPlaceholderText(QString::number(Medicine::DEFAULT_REORDER_LEVEL));
+        leftLayout->addLayout(formLayout);
+        leftLayout->addStretch();
+
+        QGridLayout *btnGrid = new QGridLayout();
+        btnGrid->setSpacing(10);
+        QPushButton *btnAdd = createBtn("ADD", successColor);
+        QPushButton *btnUpd = createBtn("UPDATE", warningColor);
+        QPushButton *btnDel = createBtn("DELETE", dangerColor);
+        QPushButton *btnClr = createBtn("CLEAR", "#6C757D");
+
+        btnGrid->addWidget(btnAdd, 0, 0); btnGrid->addWidget(btnUpd, 0, 1);
+        btnGrid->addWidget(btnDel, 1, 0); btnGrid->addWidget(btnClr, 1, 1);
+        leftLayout->addLayout(btnGrid);
+
+        connect(btnClr, &QPushButton::clicked, this, &MedicalStore::clearFields);
+        connect(btnAdd, &QPushButton::clicked, this, &MedicalStore::addMedicine);
+        connect(btnUpd, &QPushButton::clicked, this, &MedicalStore::updateMedicine);
+        connect(btnDel, &QPushButton::clicked, this, &MedicalStore::deleteMedicine);
+
+        contentLayout->addWidget(grpInput);
+        grpInput->setEnabled(false);
+
+        // 2. CENTER PANEL (Inventory)
+        QWidget *centerWidget = new QWidget();
+        QVBoxLayout *centerLayout = new QVBoxLayout(centerWidget);
+        centerLayout->setContentsMargins(0, 0, 0, 0);
+
+        QGroupBox *grpSearch = new QGroupBox("Inventory Search");
+        grpSearch->setStyleSheet(grpInput->styleSheet());
+        grpSearch->setFixedHeight(80);
+        QVBoxLayout *searchLayout = new QVBoxLayout(grpSearch);
+        txtSearch = new QLineEdit();
+        txtSearch->setPlaceholderText("Type Medicine Name or ID...");
+        connect(txtSearch, &QLineEdit::textChanged, this, &MedicalStore::onSearchTextChanged);
+        searchLayout->addWidget(txtSearch);
+        centerLayout->addWidget(grpSearch);
+
+        modelMedicines = new MedicineTableModel(core, this);
+
+        tableMedicines = new QTableView();
+        tableMedicines->setModel(modelMedicines);
+        tableMedicines->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+        // Fixed row heights let the view lay out 1M rows without measuring each one
+        tableMedicines->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        tableMedicines->setSelectionBehavior(QAbstractItemView::SelectRows);
+        tableMedicines->setSelectionMode(QAbstractItemView::SingleSelection);
+        tableMedicines->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        tableMedicines->setFocusPolicy(Qt::NoFocus);
+        tableMedicines->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        tableMedicines->setSortingEnabled(true);
+        connect(tableMedicines, &QTableView::clicked, this, &MedicalStore::onTableClick);
+        centerLayout->addWidget(tableMedicines);
+
+        QPushButton *btnAddToCart = createBtn("ADD SELECTED TO CART  ->", primaryColor);
+        btnAddToCart->setFixedHeight(60);
+        btnAddToCart->setStyleSheet("QPushButton { background-color: " + primaryColor + "; font-size: 16px; font-weight: bold; color: white; border-radius: 6px; }");
+        connect(btnAddToCart, &QPushButton::clicked, this, &MedicalStore::addToCart);
+        centerLayout->addWidget(btnAddToCart);
+
+        contentLayout->addWidget(centerWidget);
+
+        // 3. RIGHT PANEL (Cart)
+        QGroupBox *grpCart = new QGroupBox("Billing Cart");
+        grpCart->setFixedWidth(420);
+        grpCart->setStyleSheet(grpInput->styleSheet());
+        QVBoxLayout *rightLayout = new QVBoxLayout(grpCart);
+
+        txtScan = new QLineEdit();
+        txtScan->setPlaceholderText("Scan barcode / ID and press Enter");
+        connect(txtScan, &QLineEdit::returnPressed, this, &MedicalStore::onScan);
+        rightLayout->addWidget(txtScan);
+        txtScan->setFocus();
+        lblScan = new QLabel();
+        lblScan->setStyleSheet("color: #555555; font-weight: normal; background: transparent;");
+        rightLayout->addWidget(lblScan);
+
+        tableCart = new QTableWidget();
+        tableCart->setColumnCount(4);
+        tableCart->setHorizontalHeaderLabels({"Name", "Price", "Qty", "Total"});
+        tableCart->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+        rightLayout->addWidget(tableCart);
+
+        QWidget *cartBottom = new QWidget();
+        cartBottom->setStyleSheet("background-color: #E8E8E8; border-radius: 6px;");
+        QVBoxLayout *cartBottomLayout = new QVBoxLayout(cartBottom);
+
+        lblTotal = new QLabel("Total: Rs 0.00");
+        lblTotal->setAlignment(Qt::AlignCenter);
+        lblTotal->setStyleSheet("font-size: 26px; font-weight: bold; color: #333333; background: transparent; padding: 10px;");
+
+        QPushButton *btnCheckout = createBtn("CHECKOUT & PRINT", successColor);
+        btnCheckout->setFixedHeight(55);
+        btnCheckout->setStyleSheet("QPushButton { background-color: " + successColor + "; font-size: 18px; color: white; border-radius: 6px; }");
+        connect(btnCheckout, &QPushButton::clicked, this, &MedicalStore::checkout);
+
+        QPushButton *btnRemove = createBtn("Remove Item", dangerColor);
+        connect(btnRemove, &QPushButton::clicked, this, &MedicalStore::removeFromCart);
+        connect(&core, &StoreCore::cartChanged, this, &MedicalStore::refreshCart);
+        connect(&core, &StoreCore::cartLineAdded, this, &MedicalStore::updateCartLine);
+        connect(&core, &StoreCore::cartLineChanged, this, &MedicalStore::updateCartLine);
+        connect(&core, &StoreCore::cartLineRemoved, this, [=](int row) {
+            tableCart->removeRow(row);
+            showCartTotal();
+        });
+
+        QPushButton *btnPark = createBtn("Park Cart", warningColor);
+        connect(btnPark, &QPushButton::clicked, this, &MedicalStore::parkCart);
+        btnResume = createBtn("Resume (0)", primaryColor);
+        connect(btnResume, &QPushButton::clicked, this, &MedicalStore::resumeCart);
+        connect(&core, &StoreCore::parkedChanged, this, [=]() { btnResume->setText("Resume (" + QString::number(core.parkedCarts().size()) + ")"); });
+        QHBoxLayout *parkLayout = new QHBoxLayout();
+        parkLayout->addWidget(btnPark);
+        parkLayout->addWidget(btnResume);
+
+        cartBottomLayout->addWidget(lblTotal);
+        cartBottomLayout->addWidget(btnCheckout);
+        cartBottomLayout->addWidget(btnRemove);
+        cartBottomLayout->addLayout(parkLayout);
+        rightLayout->addWidget(cartBottom);
+
+        contentLayout->addWidget(grpCart);
+        grpCart->setEnabled(false);
+        connect(&core, &StoreCore::opened, grpInput, [=]() { grpInput->setEnabled(true); });
+        connect(&core, &StoreCore::opened, grpCart, [=]() {
+            grpCart->setEnabled(true);
+            txtScan->setFocus();
+        });
+        connect(modelMedicines, &MedicineTableModel::completed, this, &MedicalStore::onRowsComplete);
+        mainLayout->addLayout(contentLayout);
+
+        // --- FOOTER ---
+        QLabel *footer = new QLabel("System developed by: Muhammad Faizan U Allah | Contact: mfaizan.w2@gmail.com");
+        footer->setAlignment(Qt::AlignCenter);
+        footer->setStyleSheet("background-color: #E0E0E0; color: #555555; padding: 6px; font-size: 12px;");
+        mainLayout->addWidget(footer);
+
+        QShortcut *diagnostics = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+        connect(diagnostics, &QShortcut::activated, this, &MedicalStore::showDiagnostics);
+
+        // The first event-loop turn runs once the window has been shown
+        QTimer::singleShot(0, this, [=]() { uiReadyMs = startupTimer.elapsed(); });
+    }
+
+    ~MedicalStore() {
+        searchThread.quit();
+        searchThread.wait();
+        backupThread.quit();
+        backupThread.wait();
+        spoolThread.quit();
+        spoolThread.wait();
+    }
+
+    // Prints every checkout to 'destination' (a directory, file or printer
+    // device) on the spooler thread
+    void setPrinter(const QString &destination, ReceiptSpooler::Format format) {
+        printDestination = destination;
+        printFormat = format;
+    }
+
+    QString setReceiptTemplate(const QString &source) {
+        ReceiptTemplate compiled(source);
+        if(!compiled.isValid()) return compiled.errorString();
+        receiptLayout = compiled;
+        QMetaObject::invokeMethod(spooler, [engine = spooler, source]() { engine->setTemplate(source); });
+        return QString();
+    }
+
+private:
+    QLineEdit* createInput(QGridLayout *layout, int row, QString labelText) {
+        QLabel *lbl = new QLabel(labelText);
+        lbl->setStyleSheet("color: #333333; font-weight: bold; background: transparent;");
+        QLineEdit *txt = new QLineEdit();
+        layout->addWidget(lbl, row, 0);
+        layout->addWidget(txt, row, 1);
+        return txt;
+    }
+
+    QPushButton* createBtn(QString text, QString color) {
+        QPushButton *btn = new QPushButton(text);
+        btn->setStyleSheet("background-color: " + color + "; color: white; font-weight: bold; border-radius: 4px; padding: 10px;");
+        return btn;
+    }
+
+    void clearFields() {
+        txtId->clear(); txtId->setReadOnly(false);
+        txtName->clear(); txtPrice->clear(); txtStock->clear();
+        txtExpiry->clear(); txtCompany->clear(); txtReorder->clear();
+        tableMedicines->clearSelection();
+    }
+
+    // Inventory slot of the current selection, or -1
+    int selectedRow() const {
+        QModelIndex idx = tableMedicines->currentIndex();
+        if(!idx.isValid()) return -1;
+        return modelMedicines->slotAt(idx.row());
+    }
+
+    Medicine fieldsToMedicine(int id) const {
+        Medicine m{id, txtName->text(), txtPrice->text().toDouble(), txtStock->text().toInt(), parseExpiry(txtExpiry->text()), txtCompany->text()};
+        if(!txtReorder->text().trimmed().isEmpty()) m.reorderLevel = qMax(0, txtReorder->text().toInt());
+        return m;
+    }
+
+    void addMedicine() {
+        if(txtId->text().isEmpty() || txtName->text().isEmpty()) return;
+        int id = txtId->text().toInt();
+        Medicine m = fieldsToMedicine(id);
+        if(core.addMedicine(m) == StoreCore::DuplicateId) { QMessageBox::warning(this, "Error", "ID Exists"); return; }
+        indexMedicine(m);
+        clearFields();
+    }
+
+    void updateMedicine() {
+        if(selectedRow() < 0) return;
+        int id = txtId->text().toInt();
+        Medicine m = fieldsToMedicine(id);
+        StoreCore::Result r = core.updateMedicine(m);
+        if(r == StoreCore::InvalidInput) {
+            QMessageBox::warning(this, "Error", m.name + " is held in several lots with different expiry dates, so it cannot be given one new date here.\n"
+                                 "Change the stock to add a lot with the new date, or export to CSV, edit the lots column and import it again.");
+            return;
+        }
+        if(r == StoreCore::Ok) indexMedicine(m);
+        clearFields();
+    }
+
+    void deleteMedicine() {
+        int row = selectedRow();
+        if(row < 0) return;
+        if(QMessageBox::question(this, "Confirm", "Delete selected?") == QMessageBox::Yes) {
+            int id = inventory.idAt(row);
+            unindexMedicine(id);
+            core.removeMedicine(id);
+            clearFields();
+        }
+    }
+
+    void onTableClick(const QModelIndex &index) {
+        const Medicine m = modelMedicines->medicineAt(index.row());
+        txtId->setText(QString::number(m.id));
+        txtName->setText(m.name);
+        txtPrice->setText(QString::number(m.price));
+        txtStock->setText(QString::number(m.stock));
+        txtExpiry->setText(formatExpiry(m.expiry));
+        txtCompany->setText(m.company);
+        txtReorder->setText(QString::number(m.reorderLevel));
+        txtId->setReadOnly(true);
+    }
+
+    // --- SEARCH ---
+    void setupSearch() {
+        searchEngine = new SearchEngine();
+        searchEngine->moveToThread(&searchThread);
+        searchThread.setObjectName("search");
+        connect(&searchThread, &QThread::finished, searchEngine, &QObject::deleteLater);
+        connect(searchEngine, &SearchEngine::resultsReady, this, &MedicalStore::onSearchResults);
+        searchThread.start();
+
+        // Wait for a short pause in typing before querying
+        searchTimer = new QTimer(this);
+        searchTimer->setSingleShot(true);
+        searchTimer->setInterval(120);
+        connect(searchTimer, &QTimer::timeout, this, [=]() { refreshMedicineTable(txtSearch->text()); });
+    }
+
+    void rebuildSearch() {
+        // The worker reads a frozen copy of the records
+        InventoryStore snapshot = inventory.snapshot();
+        QMetaObject::invokeMethod(searchEngine, [engine = searchEngine, snapshot]() { engine->rebuild(snapshot); });
+    }
+
+    void onSearchTextChanged(const QString &text) {
+        if(text.isEmpty()) { refreshMedicineTable(text); return; }
+        searchTimer->start();
+    }
+
+    void refreshMedicineTable(const QString &query) {
+        searchTimer->stop();
+        quint64 ticket = ++searchTicket;
+        if(query.isEmpty()) {
+            Profiler::ScopedTimer timer(Profiler::TableRefresh);
+            modelMedicines->showAll();
+            return;
+        }
+        QMetaObject::invokeMethod(searchEngine, [engine = searchEngine, ticket, query]() { engine->runQuery(ticket, query); });
+    }
+
+    void onSearchResults(quint64 ticket, const QVector<int> &ids) {
+        if(ticket != searchTicket) return; // superseded by newer typing
+        Profiler::ScopedTimer timer(Profiler::TableRefresh);
+        modelMedicines->setMatches(ids);
+    }
+
+    void indexMedicine(const Medicine &m) {
+        QMetaObject::invokeMethod(searchEngine, [engine = searchEngine, id = m.id, name = m.name]() { engine->insert(id, name); });
+        if(!txtSearch->text().isEmpty()) refreshMedicineTable(txtSearch->text());
+    }
+
+    void unindexMedicine(int id) {
+        QMetaObject::invokeMethod(searchEngine, [engine = searchEngine, id]() { engine->remove(id); });
+    }
+
+    void addToCart() {
+        int row = selectedRow();
+        if(row < 0) { QMessageBox::warning(this, "Warning", "Select Medicine First"); return; }
+        int id = inventory.idAt(row);
+
+        bool ok;
+        int qty = QInputDialog::getInt(this, "Add to Cart", "Quantity (Stock: " + QString::number(inventory.stockAt(row)) + "):", 1, 1, 1000, 1, &ok);
+        if(!ok) return;
+        StoreCore::Result r = core.addToCart(id, qty);
+        if(r == StoreCore::OutOfStock) QMessageBox::warning(this, "Stock", "Not enough stock!");
+        else if(r == StoreCore::NotReady) QMessageBox::warning(this, "Warning", "The inventory is still loading");
+    }
+
+    void removeFromCart() {
+        core.removeCartLine(tableCart->currentRow());
+    }
+
+    // Only used when the whole cart changes (clear, checkout, park, resume)
+    void refreshCart() {
+        tableCart->setRowCount(0);
+        tableCart->setRowCount(core.cart().size());
+        for(int row=0; row<core.cart().size(); ++row) fillCartRow(row);
+        showCartTotal();
+    }
+
+    // The cart keeps a running total, so this is O(1)
+    void showCartTotal() {
+        lblTotal->setText("Total: Rs " + formatRupees(core.cartTotal()));
+    }
+
+    // Updates one cart row in place, appending it if new
+    void fillCartRow(int row) {
+        const CartItem &c = core.cart().at(row);
+        if(row >= tableCart->rowCount()) tableCart->setRowCount(row + 1);
+        const QString cells[4] = {c.name, formatRupees(c.unitPaisa), QString::number(c.qty), formatRupees(c.lineTotal())};
+        for(int col=0; col<4; ++col) {
+            if(QTableWidgetItem *item = tableCart->item(row, col)) item->setText(cells[col]);
+            else tableCart->setItem(row, col, new QTableWidgetItem(cells[col]));
+        }
+    }
+
+    void updateCartLine(int row) {
+        fillCartRow(row);
+        showCartTotal();
+    }
+
+    // --- PARKED CARTS ---
+    void parkCart() {
+        if(core.parkCart() == StoreCore::EmptyCart) return;
+        lblScan->setText("Cart parked as " + core.parkedCarts().last().label);
+        txtScan->setFocus();
+    }
+
+    void resumeCart() {
+        const QVector<StoreCore::ParkedCart> &parked = core.parkedCarts();
+        if(parked.isEmpty()) { QMessageBox::information(this, "Resume", "No parked carts."); return; }
+        int index = 0;
+        if(parked.size() > 1) {
+            QStringList items;
+            for(const auto &p : parked) {
+                items << QString("%1  (%2 items, Rs %3, %4)").arg(p.label).arg(p.cart.size())
+                             .arg(formatRupees(p.cart.total()), p.parkedAt.toString("HH:mm"));
+            }
+            bool ok;
+            QString choice = QInputDialog::getItem(this, "Resume Cart", "Parked carts:", items, 0, false, &ok);
+            if(!ok) return;
+            index = items.indexOf(choice);
+        }
+        core.resumeCart(index);
+        txtScan->setFocus();
+    }
+
+    // --- SCAN TO CART ---
+    // A scanner types the code and Enter faster than the UI repaints, so
+    // codes are queued and drained in one pass per event-loop turn: each
+    // is a direct id lookup plus one cart line update, with no search,
+    // table refresh or dialog in the way.
+    void onScan() {
+        QString code = txtScan->text().trimmed();
+        txtScan->clear();
+        if(code.isEmpty()) return;
+        scanQueue.append(code);
+        if(scanQueue.size() == 1) QTimer::singleShot(0, this, &MedicalStore::drainScans);
+    }
+
+    // Every failed scan in the burst is reported, not just the last one;
+    // the label lists the first few and the tooltip holds them all
+    void drainScans() {
+        QElapsedTimer timer;
+        timer.start();
+        const QStringList codes = scanQueue;
+        scanQueue.clear();
+        QStringList failures;
+        QString added;
+        for(const QString &code : codes) {
+            bool ok;
+            int id = code.toInt(&ok);
+            // One hash lookup per scan; only the name is read off the slot
+            const int slot = ok && core.isOpen() ? inventory.slotOf(id) : -1;
+            StoreCore::Result r = !core.isOpen() ? StoreCore::NotReady
+                                : slot < 0 ? StoreCore::NotFound : core.addSlotToCart(slot, 1);
+            if(r == StoreCore::Ok) added = "Added " + inventory.nameAt(slot) + " (x" + QString::number(core.quantityInCart(id)) + ")";
+            else if(r == StoreCore::NotFound) failures << "Unknown code: " + code;
+            else if(r == StoreCore::OutOfStock) failures << "Out of stock: " + inventory.nameAt(slot);
+            else if(r == StoreCore::NotReady) failures << "Still loading: " + code;
+        }
+
+        QString status = added;
+        if(!failures.isEmpty()) {
+            QApplication::beep();
+            const int shown = qMin(int(failures.size()), 3);
+            status = failures.mid(0, shown).join("; ");
+            if(failures.size() > shown) status += QString("; and %1 more").arg(failures.size() - shown);
+            if(failures.size() < codes.size()) status += QString(" (%1 added)").arg(codes.size() - failures.size());
+        }
+        lblScan->setText(status + QString("  [%1 scan(s), %2 ms]").arg(codes.size()).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2));
+        lblScan->setToolTip(failures.join("\n"));
+    }
+
+    void showTextDialog(const QString &title, const QString &text, const QString &buttonText) {
+        QDialog *dlg = new QDialog(this);
+        dlg->setWindowTitle(title);
+        dlg->resize(400, 500);
+        dlg->setStyleSheet("background-color: white;");
+
+        QVBoxLayout *layout = new QVBoxLayout(dlg);
+
+        QTextEdit *edit = new QTextEdit();
+        edit->setReadOnly(true);
+        edit->setPlainText(text);
+        edit->setStyleSheet("border: 1px solid black; font-family: 'Courier New'; font-size: 14px; color: black; background-color: white;");
+
+        QPushButton *btnClose = new QPushButton(buttonText);
+        btnClose->setStyleSheet("background-color: " + primaryColor + "; color: white; padding: 10px; font-weight: bold;");
+        connect(btnClose, &QPushButton::clicked, dlg, &QDialog::accept);
+
+        layout->addWidget(edit);
+        layout->addWidget(btnClose);
+        dlg->exec();
+        delete dlg;
+    }
+
+    void checkout() {
+        StoreCore::Sale sale;
+        if(core.checkout(&sale) != StoreCore::Ok) return;
+        showReceipt(sale);
+        printReceipt(sale);
+    }
+
+    // --- RECEIPTS ---
+    // The receipt window is not modal, so the next customer can be rung
+    // up while it is open; printing happens on the spooler thread.
+    void showReceipt(const Receipt &receipt) {
+        {
+            Profiler::ScopedTimer timer(Profiler::ReceiptBuild);
+            receiptText.resize(0);
+            receiptLayout.render(receipt, receiptText);
+        }
+        if(!dlgReceipt) {
+            dlgReceipt = new QDialog(this);
+            dlgReceipt->resize(400, 500);
+            dlgReceipt->setStyleSheet("background-color: white;");
+            QVBoxLayout *layout = new QVBoxLayout(dlgReceipt);
+
+            txtReceipt = new QTextEdit();
+            txtReceipt->setReadOnly(true);
+            txtReceipt->setStyleSheet("border: 1px solid black; font-family: 'Courier New'; font-size: 14px; color: black; background-color: white;");
+
+            QPushButton *btnClose = new QPushButton("Close");
+            btnClose->setStyleSheet("background-color: " + primaryColor + "; color: white; padding: 10px; font-weight: bold;");
+            connect(btnClose, &QPushButton::clicked, dlgReceipt, &QDialog::accept);
+
+            layout->addWidget(txtReceipt);
+            layout->addWidget(btnClose);
+        }
+        dlgReceipt->setWindowTitle("Receipt #" + QString::number(receipt.number));
+        txtReceipt->setPlainText(QString::fromUtf8(receiptText));
+        dlgReceipt->show();
+        dlgReceipt->raise();
+    }
+
+    void printReceipt(const Receipt &receipt) {
+        if(printDestination.isEmpty()) return;
+        QMetaObject::invokeMethod(spooler, [engine = spooler, receipt, format = printFormat, destination = printDestination]() {
+            engine->print(receipt, format, destination);
+        });
+    }
+
+    void reprintReceipt() {
+        const ReceiptArchive &archive = core.receiptArchive();
+        if(!core.isOpen() || archive.size() == 0) { QMessageBox::information(this, "Reprint", "No receipts issued yet."); return; }
+        bool ok;
+        int number = QInputDialog::getInt(this, "Reprint", "Receipt number:", archive.size(), 1, archive.size(), 1, &ok);
+        if(!ok) return;
+        Receipt receipt;
+        if(!archive.read(quint32(number), &receipt)) { QMessageBox::warning(this, "Reprint", "Receipt " + QString::number(number) + " cannot be read."); return; }
+        showReceipt(receipt);
+        printReceipt(receipt);
+    }
+
+    void exportReceipts() {
+        if(!core.isOpen()) return;
+        const QStringList ranges = {"Today", "Yesterday", "Last 7 days", "This month", "All receipts"};
+        bool ok;
+        const QString range = QInputDialog::getItem(this, "Export Receipts", "Receipts from:", ranges, 0, false, &ok);
+        if(!ok) return;
+        const QStringList formats = {"PDF", "Text", "ESC/POS"};
+        const QString formatName = QInputDialog::getItem(this, "Export Receipts", "Format:", formats, 0, false, &ok);
+        if(!ok) return;
+        const ReceiptSpooler::Format format = formatName == "PDF" ? ReceiptSpooler::Pdf
+                                              : formatName == "Text" ? ReceiptSpooler::PlainText : ReceiptSpooler::EscPos;
+        const QString path = QFileDialog::getSaveFileName(this, "Export Receipts", "receipts." + ReceiptSpooler::suffix(format));
+        if(path.isEmpty()) return;
+
+        const QDate today = QDate::currentDate();
+        QDateTime from = today.startOfDay(), to = today.addDays(1).startOfDay();
+        if(range == "Yesterday") { from = today.addDays(-1).startOfDay(); to = today.startOfDay(); }
+        else if(range == "Last 7 days") from = today.addDays(-6).startOfDay();
+        else if(range == "This month") from = QDate(today.year(), today.month(), 1).startOfDay();
+        else if(range == "All receipts") from = QDateTime::fromMSecsSinceEpoch(0);
+        QMetaObject::invokeMethod(spooler, [engine = spooler, from, to, format, path]() { engine->exportRange(from, to, format, path); });
+    }
+
+    void setupSpooler() {
+        spooler = new ReceiptSpooler(core.dataPath("receipts"));
+        spooler->moveToThread(&spoolThread);
+        spoolThread.setObjectName("spooler");
+        connect(&spoolThread, &QThread::finished, spooler, &QObject::deleteLater);
+        connect(spooler, &ReceiptSpooler::printed, this, [=](bool ok, quint32 number, const QString &message) {
+            if(!ok) lblScan->setText("Receipt #" + QString::number(number) + " not printed: " + message);
+        });
+        connect(spooler, &ReceiptSpooler::progress, this, [=](qint64 done, qint64 total) {
+            lblBackup->setText(QString("Exporting receipts %1/%2").arg(done).arg(total));
+        });
+        connect(spooler, &ReceiptSpooler::exported, this, [=](bool ok, int count, const QString &message) {
+            lblBackup->setText(ok ? QString("Exported %1 receipt(s)").arg(count) : QString("Receipt export failed"));
+            if(ok) QMessageBox::information(this, "Export Receipts", QString("Saved %1 receipt(s) to %2").arg(count).arg(message));
+            else QMessageBox::warning(this, "Export Receipts", "Export failed: " + message);
+        });
+        spoolThread.start();
+    }
+
+    // --- SALES REPORT ---
+    void showSalesReport() {
+        if(!core.isOpen()) return; // the ledger is still loading
+        const SalesLedger &ledger = core.ledger();
+        QDate today = QDate::currentDate();
+        QDateTime monthStart = QDate(today.year(), today.month(), 1).startOfDay();
+        QDateTime tomorrow = today.addDays(1).startOfDay();
+
+        QString text = "          SALES REPORT\n";
+        text += "---------------------------------\n";
+        text += "Line items recorded: " + QString::number(ledger.size()) + "\n";
+        text += "Today:       Rs " + formatRupees(ledger.revenue(today.startOfDay(), tomorrow)) + "\n";
+        text += "This month:  Rs " + formatRupees(ledger.revenue(monthStart, tomorrow)) + "\n";
+
+        text += "\n--- Last 14 days ---\n";
+        const QMap<QDate, qint64> daily = ledger.dailyRevenue(today.addDays(-13), today);
+        for(auto it = daily.cbegin(); it != daily.cend(); ++it) text += it.key().toString("yyyy-MM-dd") + QString("  Rs %1\n").arg(formatRupees(it.value()), 12);
+
+        text += "\n--- Last 12 months ---\n";
+        const QMap<QDate, qint64> monthly = ledger.monthlyRevenue(today.addMonths(-11), today);
+        for(auto it = monthly.cbegin(); it != monthly.cend(); ++it) text += it.key().toString("yyyy-MM") + QString("     Rs %1\n").arg(formatRupees(it.value()), 12);
+
+        text += "\n--- Top 10 sellers (this month) ---\n";
+        for(const auto &s : ledger.topSellers(10, monthStart, tomorrow)) {
+            const auto m = inventory.find(s.medId);
+            text += QString("%1 %2 Rs %3\n").arg(m ? m->name.left(15) : QString::number(s.medId), -15).arg(s.qty, 5).arg(formatRupees(s.revenue), 10);
+        }
+
+        text += "\n--- Revenue by company (this month) ---\n";
+        const QMap<QString, qint64> companies = ledger.companyRevenue(inventory, monthStart, tomorrow);
+        for(auto it = companies.cbegin(); it != companies.cend(); ++it) text += QString("%1 Rs %2\n").arg(it.key().left(18), -18).arg(formatRupees(it.value()), 12);
+
+        showTextDialog("Sales Report", text, "Close");
+    }
+
+    // --- EXPIRY REPORT ---
+    void showExpiringReport() {
+        bool ok;
+        int days = QInputDialog::getInt(this, "Expiring Soon", "Days ahead:", 30, 0, 3650, 1, &ok);
+        if(!ok) return;
+
+        QString text = "        EXPIRING WITHIN " + QString::number(days) + " DAYS\n";
+        text += "---------------------------------\n";
+        text += QString("%1 %2 %3\n").arg("EXPIRY", -10).arg("QTY", 5).arg("ITEM", -15);
+        text += "---------------------------------\n";
+        PackedDate today = packDate(QDate::currentDate());
+        for(const auto &lot : core.expiringWithin(days)) {
+            const auto m = inventory.find(lot.id);
+            text += QString("%1 %2 %3%4\n").arg(formatExpiry(lot.expiry), -10).arg(lot.qty, 5)
+                        .arg(m ? m->name.left(15) : QString::number(lot.id), -15).arg(lot.expiry < today ? QString(" EXPIRED") : QString());
+        }
+        showTextDialog("Expiring Soon", text, "Close");
+    }
+
+    // --- REORDER REPORT ---
+    void showReorderReport() {
+        QString text = "          REORDER REPORT\n";
+        text += "---------------------------------\n";
+        text += QString::number(inventory.lowStockCount()) + " item(s) below reorder level\n";
+        const QMap<QString, QVector<int>> groups = inventory.reorderByCompany();
+        for(auto it = groups.cbegin(); it != groups.cend(); ++it) {
+            text += "\n--- " + (it.key().isEmpty() ? QString("(no company)") : it.key()) + " ---\n";
+            text += QString("%1 %2 %3 %4\n").arg("ITEM", -15).arg("STOCK", 5).arg("LEVEL", 5).arg("ORDER", 5);
+            for(int id : it.value()) {
+                const auto m = inventory.find(id);
+                text += QString("%1 %2 %3 %4\n").arg(m->name.left(15), -15).arg(m->stock, 5).arg(m->reorderLevel, 5).arg(m->reorderQuantity(), 5);
+            }
+        }
+        showTextDialog("Reorder Report", text, "Close");
+    }
+
+    // --- STARTUP ---
+    void onDataLoaded(bool ok) {
+        // A failed lock or an unreadable inventory leaves the store unopened
+        if(!ok && !core.isOpen()) {
+            QMessageBox::critical(this, "Cannot Open Data", core.errorString() + ".");
+            QApplication::exit(0);
+            return;
+        }
+        if(!ok) QMessageBox::warning(this, "Load", core.errorString());
+        const QStringList undated = core.unreadableExpiries();
+        if(!undated.isEmpty()) {
+            showTextDialog("Unreadable Expiry Dates",
+                           "The expiry dates of these items in the old data files could not be read, so they were loaded "
+                           "without one. The old files have been kept. Re-enter the dates:\n\n" + undated.join("\n"), "Close");
+        }
+        dataReadyMs = startupTimer.elapsed();
+        rebuildSearch();
+        performAutoBackup();
+        if(modelMedicines->isComplete()) onRowsComplete();
+    }
+
+    // Failed writes are retried on every commit, so this is shown once
+    void onWriteFailed(const QString &message) {
+        if(writeFailureShown) return;
+        writeFailureShown = true;
+        QMessageBox::critical(this, "Cannot Save", message + ".\nChanges are kept in memory and retried, but they are not on disk "
+                                                   "yet. Free some disk space and keep the program open.");
+    }
+
+    // Time to first interaction: window shown, catalogue usable, all rows
+    // in the table. Logged and appended to startup.csv for tracking.
+    void onRowsComplete() {
+        if(dataReadyMs < 0) return;
+        qint64 rowsMs = startupTimer.elapsed();
+        QString line = QString("%1,%2,%3,%4,%5").arg(QDateTime::currentDateTime().toString(Qt::ISODate)).arg(inventory.size())
+                           .arg(uiReadyMs).arg(dataReadyMs).arg(rowsMs);
+        qInfo().noquote() << "startup: items,ui_ms,data_ms,rows_ms =" << line.section(',', 1);
+        QFile log(core.dataPath("startup.csv"));
+        bool fresh = !log.exists();
+        if(log.open(QIODevice::Append | QIODevice::Text)) {
+            if(fresh) log.write("time,items,ui_ms,data_ms,rows_ms\n");
+            log.write(line.toUtf8() + "\n");
+        }
+        lblBackup->setText(QString("Ready in %1 ms").arg(dataReadyMs));
+        lblBackup->setToolTip(QString("Window %1 ms, data %2 ms, all %3 rows %4 ms").arg(uiReadyMs).arg(dataReadyMs).arg(inventory.size()).arg(rowsMs));
+        dataReadyMs = -1;
+    }
+
+    // --- DASHBOARD ---
+    void showDashboard() {
+        if(!dlgDashboard) dlgDashboard = new DashboardDialog(*analytics, this);
+        dlgDashboard->show();
+        dlgDashboard->raise();
+    }
+
+    // --- DIAGNOSTICS ---
+    // Ctrl+Shift+D: live percentiles of the instrumented paths, with
+    // switches for recording and a Chrome trace export
+    void showDiagnostics() {
+        if(!dlgDiagnostics) {
+            dlgDiagnostics = new QDialog(this);
+            dlgDiagnostics->setWindowTitle("Diagnostics");
+            dlgDiagnostics->resize(760, 420);
+            QVBoxLayout *layout = new QVBoxLayout(dlgDiagnostics);
+
+            QHBoxLayout *switches = new QHBoxLayout();
+            QCheckBox *chkTimings = new QCheckBox("Record timings");
+            QCheckBox *chkTrace = new QCheckBox("Record trace");
+            chkTimings->setChecked(Profiler::isEnabled());
+            chkTrace->setChecked(Profiler::isTracing());
+            switches->addWidget(chkTimings);
+            switches->addWidget(chkTrace);
+            switches->addStretch();
+            layout->addLayout(switches);
+
+            txtDiagnostics = new QTextEdit();
+            txtDiagnostics->setReadOnly(true);
+            txtDiagnostics->setStyleSheet("font-family: 'Courier New'; font-size: 13px; color: black; background-color: white;");
+            layout->addWidget(txtDiagnostics);
+
+            QHBoxLayout *buttons = new QHBoxLayout();
+            QPushButton *btnReset = new QPushButton("Reset");
+            QPushButton *btnExport = new QPushButton("Export Trace...");
+            buttons->addStretch();
+            buttons->addWidget(btnReset);
+            buttons->addWidget(btnExport);
+            layout->addLayout(buttons);
+
+            diagnosticsTimer = new QTimer(dlgDiagnostics);
+            diagnosticsTimer->setInterval(1000);
+            connect(diagnosticsTimer, &QTimer::timeout, this, &MedicalStore::refreshDiagnostics);
+            connect(dlgDiagnostics, &QDialog::finished, diagnosticsTimer, &QTimer::stop);
+            connect(chkTimings, &QCheckBox::toggled, dlgDiagnostics, [=](bool on) {
+                Profiler::setEnabled(on);
+                if(!on) chkTrace->setChecked(false);
+                refreshDiagnostics();
+            });
+            connect(chkTrace, &QCheckBox::toggled, dlgDiagnostics, [=](bool on) {
+                Profiler::setTracing(on);
+                if(on) chkTimings->setChecked(true);
+            });
+            connect(btnReset, &QPushButton::clicked, dlgDiagnostics, [=]() {
+                Profiler::reset();
+                refreshDiagnostics();
+            });
+            connect(btnExport, &QPushButton::clicked, dlgDiagnostics, [=]() {
+                QString path = QFileDialog::getSaveFileName(dlgDiagnostics, "Export Trace", "medstore-trace.json", "Trace (*.json)");
+                if(!path.isEmpty() && !Profiler::writeTrace(path)) QMessageBox::warning(dlgDiagnostics, "Export Trace", "Cannot write " + path);
+            });
+        }
+        refreshDiagnostics();
+        diagnosticsTimer->start();
+        dlgDiagnostics->show();
+        dlgDiagnostics->raise();
+    }
+
+    void refreshDiagnostics() {
+        txtDiagnostics->setPlainText(Profiler::isEnabled() ? Profiler::report() : QString("Recording is off."));
+    }
+
+    // --- BACKUP ---
+    void setupBackup() {
+        backupEngine = new BackupEngine(BACKUP_DIR);
+        backupEngine->moveToThread(&backupThread);
+        backupThread.setObjectName("backup");
+        connect(&backupThread, &QThread::finished, backupEngine, &QObject::deleteLater);
+        connect(backupEngine, &BackupEngine::progress, this, [=](qint64 done, qint64 total) {
+            lblBackup->setText(QString("Backup %1%").arg(total > 0 ? done * 100 / total : 100));
+        });
+        connect(backupEngine, &BackupEngine::backupFinished, this, &MedicalStore::onBackupFinished);
+        connect(backupEngine, &BackupEngine::restoreFinished, this, &MedicalStore::onRestoreFinished);
+        backupThread.start();
+    }
+
+    void createBackup(QString type) {
+        if(!core.isOpen()) return; // still loading
+        // The snapshot alone is stale until the journal is replayed on top
+        // of it, and a compaction must not swap the files mid-copy: hold
+        // it until the backup thread has read all three. A running
+        // compaction is let finish rather than waited for here.
+        InventoryJournal *journal = core.journal();
+        if(journal->isCompacting()) {
+            connect(journal, &InventoryJournal::compactionFinished, this, [=]() { createBackup(type); }, Qt::SingleShotConnection);
+            return;
+        }
+        journal->holdCompaction();
+        heldJournals.append(journal);
+        core.flush();
+
+        // Sizes are taken after the flush; the engine copies no further, so
+        // sales and receipts committed after this point are left out whole
+        QVector<BackupEngine::Source> files;
+        for(const QString &path : {journal->snapshotPath(), journal->journalPath(), journal->sealedPath()}) {
+            files.append({path, QFileInfo(path).fileName(), QFileInfo(path).size()});
+        }
+        for(const QString &sub : {QString("sales"), QString("receipts")}) {
+            for(const QFileInfo &info : QDir(core.dataPath(sub)).entryInfoList(QDir::Files)) {
+                files.append({info.filePath(), sub + "/" + info.fileName(), info.size()});
+            }
+        }
+        QMetaObject::invokeMethod(backupEngine, [engine = backupEngine, type, files]() { engine->backup(type, files); });
+    }
+
+    void onBackupFinished(bool ok, const QString &type, const QString &manifest) {
+        if(!heldJournals.isEmpty()) {
+            QPointer<InventoryJournal> journal = heldJournals.takeFirst();
+            if(journal) journal->releaseCompaction();
+        }
+        lblBackup->setText(ok ? "Last backup: " + manifest.left(15) : "Backup failed");
+        if(type != "Manual") return;
+        if(ok) QMessageBox::information(this, "Backup", "Saved: " + manifest);
+        else QMessageBox::warning(this, "Backup", "Backup failed.");
+    }
+
+    void restoreBackup() {
+        if(!core.isOpen()) return;
+        if(!core.cart().isEmpty() || !core.parkedCarts().isEmpty()) {
+            QMessageBox::warning(this, "Restore", "Check out or clear the current and parked carts before restoring.");
+            return;
+        }
+        QStringList list = backupEngine->manifests();
+        if(list.isEmpty()) { QMessageBox::information(this, "Restore", "No backups found."); return; }
+        bool ok;
+        QString manifest = QInputDialog::getItem(this, "Restore Backup", "Restore point:", list, 0, false, &ok);
+        if(!ok) return;
+        if(QMessageBox::question(this, "Confirm", "Replace current inventory with " + manifest + "?") != QMessageBox::Yes) return;
+        QString staging = BACKUP_DIR + "/restore";
+        QDir(staging).removeRecursively();
+        QMetaObject::invokeMethod(backupEngine, [engine = backupEngine, manifest, staging]() { engine->restore(manifest, staging); });
+    }
+
+    void onRestoreFinished(bool ok, const QString &message) {
+        if(!ok) { QMessageBox::warning(this, "Restore", "Restore failed: " + message); return; }
+
+        // Carts may have been started while the backup was being verified
+        QString staging = BACKUP_DIR + "/restore";
+        if(!core.cart().isEmpty() || !core.parkedCarts().isEmpty()) {
+            if(QMessageBox::question(this, "Restore", "Restoring discards the current and parked carts. Continue?") != QMessageBox::Yes) {
+                QDir(staging).removeRecursively();
+                return;
+            }
+        }
+
+        // Every restored file was verified; swap them in and reload
+        bool replaced = core.replaceData(staging);
+        QDir(staging).removeRecursively();
+        if(!core.isOpen()) {
+            QMessageBox::critical(this, "Restore", "Cannot reopen the data: " + core.errorString() + ".");
+            QApplication::exit(1);
+            return;
+        }
+        rebuildSearch();
+        refreshMedicineTable(txtSearch->text());
+        if(replaced) QMessageBox::information(this, "Restore", "Restored: " + message);
+        else QMessageBox::warning(this, "Restore", "Restore failed: " + core.errorString());
+    }
+
+    void performAutoBackup() { createBackup("Auto"); }
+};
+
+#include "main.moc"
+
+int main(int argc, char *argv[]) {
+    QApplication::setStyle(QStyleFactory::create("Fusion"));
+    QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"profile", "Record latency percentiles from startup and log them on exit."});
+    parser.addOption({"trace", "Record spans from startup and write them as Chrome trace-event JSON on exit.", "file"});
+    parser.addOption({"printer", "Print every receipt to this directory, file or printer device.", "path"});
+    parser.addOption({"printer-format", "Receipt printer output: text, pdf or escpos (default text).", "format", "text"});
+    parser.addOption({"receipt-template", "Receipt layout template.", "file"});
+    parser.process(a);
+    ReceiptSpooler::Format printFormat;
+    if(!ReceiptSpooler::parseFormat(parser.value("printer-format"), &printFormat)) {
+        qWarning() << "Unknown receipt format" << parser.value("printer-format");
+        return 1;
+    }
+    QString receiptTemplate;
+    if(parser.isSet("receipt-template")) {
+        QFile file(parser.value("receipt-template"));
+        if(!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Cannot read" << file.fileName();
+            return 1;
+        }
+        receiptTemplate = QString::fromUtf8(file.readAll());
+    }
+    if(parser.isSet("trace")) Profiler::setTracing(true);
+    else if(parser.isSet("profile")) Profiler::setEnabled(true);
+
+    int rc;
+    {
+        MedicalStore w;
+        w.setPrinter(parser.value("printer"), printFormat);
+        if(!receiptTemplate.isEmpty()) {
+            const QString problem = w.setReceiptTemplate(receiptTemplate);
+            if(!problem.isEmpty()) qWarning().noquote() << "Receipt template:" << problem;
+        }
+        w.show();
+        rc = a.exec();
+    }
+    if(parser.isSet("profile")) qInfo().noquote() << Profiler::report();
+    if(parser.isSet("trace") && !Profiler::writeTrace(parser.value("trace"))) qWarning() << "Cannot write" << parser.value("trace");
+    return rc;
+}
+
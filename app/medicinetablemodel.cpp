@@ -0,0 +1,283 @@
+#include "medicinetablemodel.h"
+#include <QColor>
+#include <QBrush>
+#include <QTimer>
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+static const int PUBLISH_BATCH = 20000;
+
+template <typename T>
+static int compareValues(const T &a, const T &b) {
+    return a < b ? -1 : b < a ? 1 : 0;
+}
+
+// --- INVENTORY MODEL ---
+MedicineTableModel::MedicineTableModel(const StoreCore &core, QObject *parent)
+    : QAbstractTableModel(parent), inventory(core.inventory()) {
+    // Structural changes past the published rows are left to publishBatch();
+    // a sorted model places a new record once it is in the store
+    connect(&core, &StoreCore::aboutToInsert, this, [this](int slot) {
+        pendingVisible = slot == shown;
+        if(pendingVisible && !isMapped()) beginInsertRows(QModelIndex(), slot, slot);
+    });
+    connect(&core, &StoreCore::inserted, this, [this](int slot) {
+        if(pendingVisible) {
+            ++shown;
+            if(!isMapped()) endInsertRows();
+        }
+        if(!isMapped() || filtering) return;
+        const int row = sortedPosition(slot, 0, rows.size());
+        beginInsertRows(QModelIndex(), row, row);
+        rows.insert(row, slot);
+        renumber(row, rows.size());
+        endInsertRows();
+    });
+    // A swap-remove drops the last row and refills the freed one
+    connect(&core, &StoreCore::aboutToRemove, this, [this](int slot, int last) {
+        pendingVisible = last < shown;
+        if(isMapped()) {
+            removingRow = rowOf(slot);
+            if(removingRow >= 0) beginRemoveRows(QModelIndex(), removingRow, removingRow);
+        } else if(pendingVisible) {
+            beginRemoveRows(QModelIndex(), last, last);
+        }
+    });
+    connect(&core, &StoreCore::removed, this, [this](int refilled) {
+        if(pendingVisible) --shown;
+        if(!isMapped()) {
+            if(pendingVisible) endRemoveRows();
+            if(refilled >= 0 && refilled < shown) emitRowChanged(refilled);
+            return;
+        }
+        // The record from the last slot keeps its row under its new slot
+        const int last = inventory.size();
+        if(removingRow >= 0) {
+            setRowOf(rows[removingRow], -1);
+            rows.remove(removingRow);
+            renumber(removingRow, rows.size());
+        }
+        if(refilled >= 0) {
+            const int row = rowOf(last);
+            setRowOf(last, -1);
+            setRowOf(refilled, row);
+            if(row >= 0) rows[row] = refilled;
+        }
+        if(removingRow >= 0) endRemoveRows();
+        removingRow = -1;
+    });
+    // Stock drives the low-stock colouring, so whole rows are repainted
+    connect(&core, &StoreCore::changed, this, [this](int slot) {
+        const int row = isMapped() ? rowOf(slot) : slot < shown ? slot : -1;
+        if(row < 0) return;
+        if(sortColumn >= 0) reposition(row);
+        else emitRowChanged(row);
+    });
+    connect(&core, &StoreCore::aboutToReset, this, [this]() { beginResetModel(); });
+    connect(&core, &StoreCore::reset, this, [this]() {
+        shown = qMin(int(inventory.size()), PUBLISH_BATCH);
+        // Every slot may hold a different record now
+        rows.clear();
+        rowOfSlot.clear();
+        mapRows();
+        endResetModel();
+        if(isComplete()) emit completed();
+        else QTimer::singleShot(0, this, &MedicineTableModel::publishBatch);
+    });
+}
+
+void MedicineTableModel::publishBatch() {
+    if(isComplete()) return;
+    int next = qMin(int(inventory.size()), shown + PUBLISH_BATCH);
+    if(isMapped()) {
+        shown = next;
+    } else {
+        beginInsertRows(QModelIndex(), shown, next - 1);
+        shown = next;
+        endInsertRows();
+    }
+    if(isComplete()) emit completed();
+    else QTimer::singleShot(0, this, &MedicineTableModel::publishBatch);
+}
+
+void MedicineTableModel::setMatches(const QVector<int> &sortedIds) {
+    beginResetModel();
+    filtering = true;
+    matchIds = sortedIds;
+    mapRows();
+    endResetModel();
+}
+
+void MedicineTableModel::showAll() {
+    if(!filtering) return;
+    beginResetModel();
+    filtering = false;
+    matchIds.clear();
+    mapRows();
+    endResetModel();
+}
+
+void MedicineTableModel::sort(int column, Qt::SortOrder order) {
+    const int wanted = column >= 0 && column < ColumnCount ? column : -1;
+    if(wanted == sortColumn && (wanted < 0 || order == sortOrder)) return;
+    // Leaving or entering slot order mid-publish changes the row count
+    if(!filtering && !isComplete()) {
+        beginResetModel();
+        sortColumn = wanted;
+        sortOrder = order;
+        mapRows();
+        endResetModel();
+        return;
+    }
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    // The selection and current row stay on the same records
+    const QModelIndexList from = persistentIndexList();
+    QVector<int> fromSlots;
+    fromSlots.reserve(from.size());
+    for(const QModelIndex &i : from) fromSlots.append(slotAt(i.row()));
+    sortColumn = wanted;
+    sortOrder = order;
+    mapRows();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for(int i=0; i<from.size(); ++i) {
+        const int row = isMapped() ? rowOf(fromSlots[i]) : fromSlots[i];
+        to.append(row >= 0 ? index(row, from[i].column()) : QModelIndex());
+    }
+    changePersistentIndexList(from, to);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+// Rows from the matches, or from every slot when only sorting; ids
+// deleted since the query ran are dropped
+void MedicineTableModel::mapRows() {
+    for(int slot : rows) setRowOf(slot, -1);
+    rows.clear();
+    if(!isMapped()) return;
+    if(filtering) {
+        rows.reserve(matchIds.size());
+        for(int id : matchIds) {
+            const int slot = inventory.slotOf(id);
+            if(slot >= 0) rows.append(slot);
+        }
+    } else {
+        rows.resize(inventory.size());
+        std::iota(rows.begin(), rows.end(), 0);
+    }
+    if(sortColumn >= 0) std::sort(rows.begin(), rows.end(), [this](int a, int b) { return before(a, b); });
+    renumber(0, rows.size());
+}
+
+void MedicineTableModel::renumber(int from, int to) {
+    for(int row=from; row<to; ++row) setRowOf(rows[row], row);
+}
+
+int MedicineTableModel::rowOf(int slot) const {
+    return slot < rowOfSlot.size() ? rowOfSlot[slot] : -1;
+}
+
+void MedicineTableModel::setRowOf(int slot, int row) {
+    if(slot >= rowOfSlot.size()) {
+        if(row < 0) return;
+        rowOfSlot.resize(qMax(slot + 1, int(inventory.size())), -1);
+    }
+    rowOfSlot[slot] = row;
+}
+
+// Sort order of two slots; ties go by id, so the order is total and a
+// record's position can be found by binary search
+bool MedicineTableModel::before(int a, int b) const {
+    if(sortOrder == Qt::DescendingOrder) std::swap(a, b);
+    int c = 0;
+    switch(sortColumn) {
+    case ColName:    c = inventory.nameViewAt(a).compare(inventory.nameViewAt(b)); break;
+    case ColPrice:   c = compareValues(inventory.priceAt(a), inventory.priceAt(b)); break;
+    case ColStock:   c = compareValues(inventory.stockAt(a), inventory.stockAt(b)); break;
+    case ColExpiry: {
+        // Undated records sort after every date
+        const PackedDate ea = inventory.expiryAt(a), eb = inventory.expiryAt(b);
+        c = compareValues(ea ? ea : UINT_MAX, eb ? eb : UINT_MAX);
+        break;
+    }
+    case ColCompany: c = inventory.companyAt(a).compare(inventory.companyAt(b)); break;
+    }
+    return c != 0 ? c < 0 : inventory.idAt(a) < inventory.idAt(b);
+}
+
+// Where 'slot' belongs among the sorted rows [begin, end)
+int MedicineTableModel::sortedPosition(int slot, int begin, int end) const {
+    auto it = std::lower_bound(rows.constBegin() + begin, rows.constBegin() + end, slot, [this](int rowSlot, int s) { return before(rowSlot, s); });
+    return int(it - rows.constBegin());
+}
+
+// Moves a changed row to where its new values sort; every other row is
+// still in order, so only the rows it passes are renumbered
+void MedicineTableModel::reposition(int row) {
+    const int slot = rows[row];
+    int to = row, destination = row;
+    if(row > 0 && before(slot, rows[row - 1])) {
+        to = destination = sortedPosition(slot, 0, row);
+    } else if(row + 1 < rows.size() && before(rows[row + 1], slot)) {
+        destination = sortedPosition(slot, row + 1, rows.size());
+        to = destination - 1;
+    }
+    if(to != row) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+        if(to < row) std::rotate(rows.begin() + to, rows.begin() + row, rows.begin() + row + 1);
+        else std::rotate(rows.begin() + row, rows.begin() + row + 1, rows.begin() + to + 1);
+        renumber(qMin(row, to), qMax(row, to) + 1);
+        endMoveRows();
+    }
+    emitRowChanged(to);
+}
+
+int MedicineTableModel::rowOfId(int id) const {
+    const int slot = inventory.slotOf(id);
+    if(slot < 0) return -1;
+    return isMapped() ? rowOf(slot) : slot < shown ? slot : -1;
+}
+
+int MedicineTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : isMapped() ? int(rows.size()) : shown;
+}
+
+int MedicineTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant MedicineTableModel::data(const QModelIndex &index, int role) const {
+    if(!index.isValid() || index.row() >= rowCount()) return QVariant();
+    // Read only the column being drawn rather than assembling a Medicine
+    const int slot = slotAt(index.row());
+
+    if(role == Qt::DisplayRole) {
+        switch(index.column()) {
+        case ColId:      return QString::number(inventory.idAt(slot));
+        case ColName:    return inventory.nameAt(slot);
+        case ColPrice:   return QString::number(inventory.priceAt(slot));
+        case ColStock:   return QString::number(inventory.stockAt(slot));
+        case ColExpiry:  return formatExpiry(inventory.expiryAt(slot));
+        case ColCompany: return inventory.companyAt(slot);
+        }
+    } else if(role == Qt::ToolTipRole && index.column() == ColExpiry) {
+        const QVector<Lot> lots = inventory.lotsAt(slot);
+        if(lots.size() > 1) return Medicine::summarizeLots(lots);
+    } else if(role == Qt::BackgroundRole) {
+        if(inventory.needsReorderAt(slot)) return QBrush(QColor("#FFCDD2"));
+    } else if(role == Qt::ForegroundRole) {
+        if(inventory.needsReorderAt(slot)) return QBrush(Qt::black);
+    }
+    return QVariant();
+}
+
+QVariant MedicineTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if(role != Qt::DisplayRole || orientation != Qt::Horizontal) return QAbstractTableModel::headerData(section, orientation, role);
+    static const char *labels[ColumnCount] = {"ID", "Name", "Price", "Stock", "Expiry", "Company"};
+    return (section >= 0 && section < ColumnCount) ? QString(labels[section]) : QVariant();
+}
+
+void MedicineTableModel::emitRowChanged(int row) {
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
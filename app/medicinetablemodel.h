@@ -0,0 +1,82 @@
+#ifndef MEDICINETABLEMODEL_H
+#define MEDICINETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "storecore.h"
+
+// --- INVENTORY MODEL ---
+// Exposes the StoreCore inventory to the view without copying it. The
+// core's change signals are forwarded as row-level model signals, so the
+// view is never rebuilt for a single-record edit.
+//
+// After a reset (initial load, import, restore) rows are published in
+// batches, one per event-loop turn, so a large catalogue shows up at once
+// and fills in while the window stays responsive. Records beyond the
+// published rows are picked up by the following batches.
+//
+// Unsorted and unfiltered, row == slot. setMatches() (a SearchEngine
+// result) or sort() switch to a row map holding only the visible slots,
+// so a keystroke costs its matches and a sort the visible rows, never a
+// pass over the whole catalogue. While sorted, a changed, added or
+// removed record moves, enters or leaves at its own position; the map is
+// not rebuilt. Records added while narrowed are left to the next query.
+class MedicineTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { ColId, ColName, ColPrice, ColStock, ColExpiry, ColCompany, ColumnCount };
+
+    explicit MedicineTableModel(const StoreCore &core, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    // Rows are numbered 1..n in the order shown
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    // A negative column restores slot order
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Shows only these ids until showAll()
+    void setMatches(const QVector<int> &sortedIds);
+    void showAll();
+
+    int slotAt(int row) const { return isMapped() ? rows[row] : row; }
+    Medicine medicineAt(int row) const { return inventory.at(slotAt(row)); }
+    int idAt(int row) const { return inventory.idAt(slotAt(row)); }
+    // -1 when the id is not shown
+    int rowOfId(int id) const;
+    bool isComplete() const { return shown == inventory.size(); }
+
+signals:
+    // Every row has been published since the last reset
+    void completed();
+
+private:
+    const InventoryStore &inventory;
+    int shown = 0;
+    bool pendingVisible = false;
+
+    bool filtering = false;
+    QVector<int> matchIds;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    // Mapped rows: the slot of each row, and the row of each slot (-1 when
+    // not shown). rowOfSlot only grows, so resetting it costs the rows.
+    QVector<int> rows;
+    QVector<int> rowOfSlot;
+    int removingRow = -1;
+
+    bool isMapped() const { return filtering || sortColumn >= 0; }
+    int rowOf(int slot) const;
+    void setRowOf(int slot, int row);
+    void mapRows();
+    void renumber(int from, int to);
+    bool before(int slotA, int slotB) const;
+    int sortedPosition(int slot, int begin, int end) const;
+    void reposition(int row);
+    void emitRowChanged(int row);
+    void publishBatch();
+};
+
+#endif // MEDICINETABLEMODEL_H
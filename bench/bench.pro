@@ -0,0 +1,9 @@
+QT       = core
+TARGET = medstore-bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+SOURCES += main.cpp
+
+include(../core/core.pri)
+win32: LIBS += -lpsapi
@@ -0,0 +1,435 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QMutex>
+#include <QSet>
+#include <algorithm>
+#include <functional>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "storecore.h"
+#include "inventoryfile.h"
+#include "searchindex.h"
+#include "inventoryanalytics.h"
+#include "checkoutserver.h"
+#include "counterclient.h"
+#include "receiptspooler.h"
+
+// --- BENCHMARK HARNESS ---
+// Every iteration is timed on its own so latency percentiles can be
+// reported next to throughput. Results go to stdout as a table and, with
+// --json, to a machine-readable file for comparing releases.
+
+struct Result {
+    QString name;
+    int catalogue = 0;
+    int param = 0;
+    QVector<qint64> samples; // nanoseconds
+    qint64 peakKb = 0;
+    // Set for concurrent runs: throughput is samples over wall time
+    qint64 wallNs = 0;
+};
+
+static qint64 peakMemoryKb() {
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS pmc;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return qint64(pmc.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static qint64 percentile(const QVector<qint64> &sorted, double p) {
+    if(sorted.isEmpty()) return 0;
+    int idx = qBound(0, int(p * (sorted.size() - 1) + 0.5), int(sorted.size()) - 1);
+    return sorted[idx];
+}
+
+static QTextStream &out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QVector<Result> results;
+
+static double opsPerSec(const Result &r) {
+    qint64 total = r.wallNs;
+    if(total == 0) for(qint64 ns : r.samples) total += ns;
+    return total > 0 ? double(r.samples.size()) * 1e9 / total : 0.0;
+}
+
+static void report(Result r) {
+    r.peakKb = peakMemoryKb();
+    QVector<qint64> sorted = r.samples;
+    std::sort(sorted.begin(), sorted.end());
+    out() << QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                 .arg(r.name, -22).arg(r.catalogue, 9).arg(r.param, 5)
+                 .arg(opsPerSec(r), 14, 'f', 1)
+                 .arg(percentile(sorted, 0.50) / 1000.0, 11, 'f', 1)
+                 .arg(percentile(sorted, 0.90) / 1000.0, 11, 'f', 1)
+                 .arg(percentile(sorted, 0.99) / 1000.0, 11, 'f', 1)
+                 .arg(r.peakKb / 1024, 9);
+    out().flush();
+    results.append(r);
+}
+
+static void measure(const QString &name, int catalogue, int param, int iterations, const std::function<void(int)> &fn) {
+    Result r;
+    r.name = name;
+    r.catalogue = catalogue;
+    r.param = param;
+    r.samples.reserve(iterations);
+    QElapsedTimer timer;
+    for(int i=0; i<iterations; ++i) {
+        timer.start();
+        fn(i);
+        r.samples.append(timer.nsecsElapsed());
+    }
+    report(r);
+}
+
+// --- SYNTHETIC CATALOGUE ---
+static QVector<Medicine> makeCatalogue(int size, quint32 seed) {
+    static const char *stems[] = {"Paracet", "Amoxi", "Ibupro", "Cetiri", "Omepra", "Metfor", "Azithro", "Losar",
+                                  "Atorva", "Panto", "Diclo", "Cipro", "Levo", "Monte", "Salbu", "Insu"};
+    static const char *suffixes[] = {"amol", "cillin", "fen", "zine", "zole", "min", "mycin", "tan"};
+    static const char *forms[] = {"Tab", "Cap", "Syrup", "Inj", "Drops", "Cream"};
+    QRandomGenerator rng(seed);
+    QVector<Medicine> list;
+    list.reserve(size);
+    for(int i=0; i<size; ++i) {
+        Medicine m;
+        m.id = 100000 + i;
+        m.name = QString("%1%2 %3mg %4").arg(QLatin1String(stems[rng.bounded(16)]), QLatin1String(suffixes[rng.bounded(8)]))
+                     .arg(rng.bounded(1, 100) * 10).arg(QLatin1String(forms[rng.bounded(6)]));
+        m.price = rng.bounded(500, 500000) / 100.0;
+        m.stock = rng.bounded(1000, 5000);
+        m.expiry = packDate(QDate(2026 + rng.bounded(5), rng.bounded(1, 13), 28));
+        m.company = QString("Pharma Co %1").arg(rng.bounded(200));
+        list.append(m);
+    }
+    return list;
+}
+
+// Store footprint next to what the same records take as a Medicine array,
+// with every company string counted once as the snapshot reader shares them
+static void reportMemory(const InventoryStore &store, const QVector<Medicine> &catalogue) {
+    qint64 records = qint64(catalogue.size()) * qint64(sizeof(Medicine));
+    QSet<QString> companies;
+    for(const auto &m : catalogue) {
+        records += 16 + m.name.capacity() * qint64(sizeof(QChar));
+        if(!m.lots.isEmpty()) records += 16 + m.lots.capacity() * qint64(sizeof(Lot));
+        companies.insert(m.company);
+    }
+    for(const QString &c : companies) records += 16 + c.size() * qint64(sizeof(QChar));
+
+    const InventoryStore::MemoryUsage usage = store.memoryUsage();
+    const double n = qMax(1, store.size());
+    out() << QString("  store memory: %1 MB, %2 B/SKU (columns %3, names %4, companies %5, lots %6, indexes %7); "
+                     "as Medicine records: %8 B/SKU\n")
+                 .arg(usage.total() / 1048576.0, 0, 'f', 1).arg(usage.total() / n, 0, 'f', 1)
+                 .arg(usage.columns / n, 0, 'f', 1).arg(usage.names / n, 0, 'f', 1).arg(usage.companies / n, 0, 'f', 1)
+                 .arg(usage.lots / n, 0, 'f', 1).arg(usage.indexes / n, 0, 'f', 1).arg(records / n, 0, 'f', 1);
+    out().flush();
+}
+
+static void runSize(int size, const QVector<int> &cartSizes) {
+    QTemporaryDir dir;
+    const QVector<Medicine> catalogue = makeCatalogue(size, 42);
+    const int fileIters = size >= 1000000 ? 3 : size >= 100000 ? 5 : 20;
+
+    // --- LAYOUT ---
+    InventoryStore store;
+    measure("build_store", size, 0, 1, [&](int) { store.assign(catalogue); });
+    reportMemory(store, catalogue);
+    qint64 stockValue = 0;
+    measure("valuation_scan", size, 0, 20, [&](int) {
+        stockValue = 0;
+        for(int slot=0; slot<store.size(); ++slot) stockValue += toPaisa(store.priceAt(slot)) * store.stockAt(slot);
+    });
+    out() << "  stock value: Rs " << formatRupees(stockValue) << "\n";
+    // A write while a background copy is alive pays for detaching the
+    // columns it touches; without one it is a plain update
+    measure("sale_write", size, 0, 50, [&](int i) { store.takeStock(catalogue[i % size].id, 1); });
+    measure("sale_during_snapshot", size, 0, 20, [&](int i) {
+        const InventoryStore copy = store.snapshot();
+        store.takeStock(catalogue[i % size].id, 1);
+    });
+    measure("sale_during_full_copy", size, 0, 5, [&](int i) {
+        const InventoryStore copy = store;
+        store.takeStock(catalogue[i % size].id, 1);
+    });
+
+    // --- PERSISTENCE ---
+    const QString snapshot = dir.filePath("bench.inv");
+    measure("save_snapshot", size, 0, fileIters, [&](int) { InventoryFile::write(snapshot, store); });
+    measure("load_snapshot", size, 0, fileIters, [&](int) {
+        InventoryStore loaded;
+        InventoryFile::read(snapshot, loaded);
+    });
+
+    StoreCore core(dir.filePath("store"));
+    core.open();
+    core.importMedicines(catalogue);
+    measure("open_store", size, 0, fileIters, [&](int) {
+        core.close();
+        core.open();
+    });
+
+    // --- SEARCH ---
+    SearchIndex index;
+    measure("search_index_build", size, 0, 1, [&](int) {
+        index.build(store);
+    });
+    measure("expiring_30d", size, 0, 50, [&](int) { core.expiringWithin(30); });
+    const QStringList queries = {"p", "pa", "para", "paracetamol", "zole 2", "1000", "100", "cap", "xyz"};
+    for(const QString &q : queries) {
+        QString folded = SearchIndex::fold(q);
+        measure("search:" + q, size, 0, 50, [&](int) { index.search(folded); });
+    }
+    QString typed = "paracetamol";
+    measure("search_typing", size, typed.size(), 50, [&](int) {
+        QVector<int> prev;
+        for(int len=1; len<=typed.size(); ++len) {
+            QString q = typed.left(len);
+            prev = len > 1 ? index.search(q, &prev) : index.search(q);
+        }
+    });
+
+    // --- CART & CHECKOUT ---
+    QRandomGenerator rng(7);
+    for(int lines : cartSizes) {
+        const int rounds = 50;
+        measure("add_to_cart", size, lines, rounds, [&](int) {
+            core.clearCart();
+            for(int k=0; k<lines; ++k) core.addToCart(catalogue[rng.bounded(size)].id, 1);
+        });
+        measure("checkout+commit", size, lines, rounds, [&](int) {
+            core.clearCart();
+            for(int k=0; k<lines; ++k) core.addToCart(catalogue[rng.bounded(size)].id, 1);
+            core.checkout();
+            core.flush();
+        });
+    }
+
+    // --- ANALYTICS ---
+    // A full pass over every block, then the refresh after one sale, which
+    // only recomputes the block holding the sold item
+    InventoryAnalytics analytics(core);
+    measure("analytics_full", size, 0, 20, [&](int) {
+        analytics.invalidateAll();
+        analytics.refreshNow();
+    });
+    Result incremental;
+    incremental.name = "analytics_after_sale";
+    incremental.catalogue = size;
+    QElapsedTimer timer;
+    for(int i=0; i<50; ++i) {
+        core.addToCart(catalogue[rng.bounded(size)].id, 1);
+        core.checkout();
+        timer.start();
+        analytics.refreshNow();
+        incremental.samples.append(timer.nsecsElapsed());
+    }
+    report(incremental);
+
+    // --- RECEIPTS ---
+    // Rendering into a reused buffer, a reprint straight from the archive,
+    // and bulk re-rendering of every archived receipt into each format
+    for(int i=0; i<2000; ++i) {
+        QVector<CartItem> lines;
+        for(int k=0; k<5; ++k) {
+            const Medicine &m = catalogue[rng.bounded(size)];
+            lines.append({m.id, m.name, toPaisa(m.price), 1});
+        }
+        core.recordSale(lines);
+    }
+    core.flush();
+    const ReceiptArchive &archive = core.receiptArchive();
+    Receipt receipt;
+    archive.read(quint32(archive.size()), &receipt);
+    const ReceiptTemplate layout;
+    QByteArray text;
+    measure("receipt_render", size, int(receipt.lines.size()), 1000, [&](int) {
+        text.resize(0);
+        layout.render(receipt, text);
+    });
+    measure("receipt_reprint", size, 0, 1000, [&](int) { archive.read(1 + rng.bounded(quint32(archive.size())), &receipt); });
+    ReceiptSpooler spooler(core.dataPath("receipts"));
+    const QDateTime from = QDateTime::fromMSecsSinceEpoch(0), to = QDateTime::currentDateTime().addDays(1);
+    const char *formats[] = {"text", "pdf", "escpos"};
+    for(const char *name : formats) {
+        ReceiptSpooler::Format format;
+        ReceiptSpooler::parseFormat(name, &format);
+        measure(QString("receipt_export:") + name, size, archive.size(), 3, [&](int) {
+            spooler.exportRange(from, to, format, dir.filePath("receipts." + ReceiptSpooler::suffix(format)));
+        });
+    }
+    out() << "  receipt archive: " << archive.size() << " receipts, " << archive.dataSize() / 1024 << " KB\n";
+}
+
+// --- CHECKOUT SERVER ---
+// Several counters check out carts against a small set of hot items with
+// little stock, so reservations contend and items sell out mid-run. Each
+// sample is one cart: reserve every line, then check out. Afterwards the
+// units the counters were told they sold must match the stock that left
+// the store, with no item below zero.
+static void runServer(int size, const QVector<int> &counters) {
+    static const int HOT_ITEMS = 64;
+    static const int HOT_STOCK = 40;
+    static const int CARTS_PER_COUNTER = 200;
+    static const int LINES_PER_CART = 3;
+
+    QVector<Medicine> catalogue = makeCatalogue(size, 42);
+    const int hot = qMin(HOT_ITEMS, int(catalogue.size()));
+    for(int i=0; i<hot; ++i) catalogue[i].stock = HOT_STOCK;
+
+    const QVector<Medicine> &items = catalogue;
+
+    for(int n : counters) {
+        if(n <= 0) continue;
+        QTemporaryDir dir;
+        const QString name = QString("medstore-bench-%1-%2").arg(QCoreApplication::applicationPid()).arg(n);
+
+        // The store and server live on their own event loop thread
+        QThread serverThread;
+        QObject anchor;
+        anchor.moveToThread(&serverThread);
+        serverThread.start();
+        StoreCore *core = nullptr;
+        CheckoutServer *server = nullptr;
+        bool listening = false;
+        QMetaObject::invokeMethod(&anchor, [&]() {
+            core = new StoreCore(dir.filePath("store"));
+            core->open();
+            core->importMedicines(catalogue);
+            server = new CheckoutServer(*core);
+            listening = server->listen(name);
+        }, Qt::BlockingQueuedConnection);
+
+        Result r;
+        r.name = "server_checkout";
+        r.catalogue = size;
+        r.param = n;
+        QMutex merge;
+        qint64 unitsSold = 0;
+        QElapsedTimer wall;
+        wall.start();
+        QVector<QThread *> clients;
+        for(int c=0; listening && c<n; ++c) {
+            clients.append(QThread::create([&, c]() {
+                CounterClient client;
+                if(!client.connectTo(name)) return;
+                QRandomGenerator rng(1000 + c);
+                QVector<qint64> samples;
+                qint64 sold = 0;
+                QElapsedTimer timer;
+                for(int k=0; k<CARTS_PER_COUNTER; ++k) {
+                    timer.start();
+                    for(int l=0; l<LINES_PER_CART; ++l) client.reserve(items[rng.bounded(hot)].id, rng.bounded(1, 4));
+                    CounterProtocol::Reply reply = client.checkout();
+                    samples.append(timer.nsecsElapsed());
+                    for(const auto &line : reply.lines) sold += line.qty;
+                }
+                QMutexLocker locker(&merge);
+                r.samples += samples;
+                unitsSold += sold;
+            }));
+            clients.last()->start();
+        }
+        for(QThread *t : clients) {
+            t->wait();
+            delete t;
+        }
+        r.wallNs = wall.nsecsElapsed();
+
+        qint64 stockLeft = 0;
+        bool negative = false;
+        QMetaObject::invokeMethod(&anchor, [&]() {
+            server->close();
+            for(int i=0; i<hot; ++i) {
+                int stock = core->inventory().stockAt(core->inventory().slotOf(catalogue[i].id));
+                stockLeft += stock;
+                negative |= stock < 0;
+            }
+            delete server;
+            core->close();
+            delete core;
+        }, Qt::BlockingQueuedConnection);
+        serverThread.quit();
+        serverThread.wait();
+
+        report(r);
+        qint64 stockSold = qint64(hot) * HOT_STOCK - stockLeft;
+        out() << QString("  sold %1 units, stock dropped by %2: %3\n").arg(unitsSold).arg(stockSold)
+                     .arg(listening && unitsSold == stockSold && !negative ? QString("ok") : QString("MISMATCH"));
+        out().flush();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Medical Store inventory benchmarks");
+    parser.addHelpOption();
+    parser.addOption({"sizes", "Comma-separated catalogue sizes.", "list", "1000,10000,100000,1000000"});
+    parser.addOption({"carts", "Comma-separated cart sizes.", "list", "1,10,50,200"});
+    parser.addOption({"counters", "Comma-separated counter counts for the checkout server (0 to skip).", "list", "1,4,16"});
+    parser.addOption({"json", "Write results as JSON to this file.", "file"});
+    parser.process(app);
+
+    QVector<int> sizes, carts, counters;
+    for(const QString &v : parser.value("sizes").split(',')) sizes.append(v.toInt());
+    for(const QString &v : parser.value("carts").split(',')) carts.append(v.toInt());
+    for(const QString &v : parser.value("counters").split(',')) counters.append(v.toInt());
+
+    out() << QString("%1 %2 %3 %4 %5 %6 %7 %8\n").arg("benchmark", -22).arg("catalogue", 9).arg("param", 5)
+                 .arg("ops/s", 14).arg("p50 us", 11).arg("p90 us", 11).arg("p99 us", 11).arg("peak MB", 9);
+    for(int size : sizes) if(size > 0) runSize(size, carts);
+    if(!sizes.isEmpty() && sizes.first() > 0) runServer(sizes.first(), counters);
+
+    if(parser.isSet("json")) {
+        QJsonArray list;
+        for(const Result &r : results) {
+            QVector<qint64> sorted = r.samples;
+            std::sort(sorted.begin(), sorted.end());
+            QJsonObject o;
+            o["name"] = r.name;
+            o["catalogue"] = r.catalogue;
+            o["param"] = r.param;
+            o["iterations"] = int(sorted.size());
+            o["ops_per_sec"] = opsPerSec(r);
+            o["p50_ns"] = percentile(sorted, 0.50);
+            o["p90_ns"] = percentile(sorted, 0.90);
+            o["p99_ns"] = percentile(sorted, 0.99);
+            o["max_ns"] = sorted.isEmpty() ? 0 : sorted.last();
+            o["peak_rss_kb"] = r.peakKb;
+            list.append(o);
+        }
+        QFile file(parser.value("json"));
+        if(!file.open(QIODevice::WriteOnly)) return 1;
+        file.write(QJsonDocument(QJsonObject{{"version", 1}, {"results", list}}).toJson());
+    }
+    return 0;
+}
@@ -0,0 +1,8 @@
+QT       = core
+TARGET = medstore-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+SOURCES += main.cpp
+
+include(../core/core.pri)
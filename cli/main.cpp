@@ -0,0 +1,280 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "storecore.h"
+#include "csvio.h"
+#include "counterclient.h"
+#include "profiler.h"
+#include "inventoryanalytics.h"
+#include "receiptspooler.h"
+
+// Lines handed to the parser per batch while the file is streamed
+static const int CHUNK_LINES = 50000;
+
+static QTextStream &out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// Prints the profile and writes the trace requested on the command line
+static void finishProfile(const QCommandLineParser &parser) {
+    if(!Profiler::isEnabled()) return;
+    out() << "\n" << Profiler::report();
+    if(parser.isSet("trace") && !Profiler::writeTrace(parser.value("trace"))) out() << "Cannot write " << parser.value("trace") << "\n";
+    out().flush();
+}
+
+static int importCsv(StoreCore &core, const QString &path) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        out() << "Cannot open " << path << Qt::endl;
+        return 1;
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    QTextStream in(&file);
+    QVector<Medicine> records;
+    int rejected = 0;
+    bool first = true;
+    while(!in.atEnd()) {
+        QStringList lines;
+        lines.reserve(CHUNK_LINES);
+        while(lines.size() < CHUNK_LINES && !in.atEnd()) {
+            QString line = in.readLine();
+            if(first) {
+                first = false;
+                if(line.trimmed().toLower().startsWith("id,")) continue;
+            }
+            lines.append(line);
+        }
+        int bad = 0;
+        records.append(CsvIO::parseParallel(lines, &bad));
+        rejected += bad;
+    }
+    qint64 parseMs = timer.elapsed();
+
+    // Single bulk commit: one snapshot write for the whole file
+    int added = core.importMedicines(records);
+    out() << "Imported " << records.size() << " records (" << added << " new, "
+          << records.size() - added << " updated, " << rejected << " rejected) in "
+          << parseMs << " ms parse + " << timer.elapsed() - parseMs << " ms commit" << Qt::endl;
+    return rejected > 0 ? 2 : 0;
+}
+
+static int exportCsv(const StoreCore &core, const QString &path) {
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        out() << "Cannot write " << path << Qt::endl;
+        return 1;
+    }
+    QTextStream stream(&file);
+    stream << CsvIO::HEADER << "\n";
+    const InventoryStore &store = core.inventory();
+    for(int slot=0; slot<store.size(); ++slot) stream << CsvIO::formatMedicine(store.at(slot)) << "\n";
+    stream.flush();
+    if(!file.commit()) return 1;
+    out() << "Exported " << core.inventory().size() << " records to " << path << Qt::endl;
+    return 0;
+}
+
+static QString statusText(quint8 status) {
+    switch(status) {
+    case CounterProtocol::Ok:          return "ok";
+    case CounterProtocol::NotFound:    return "not found";
+    case CounterProtocol::OutOfStock:  return "out of stock";
+    case CounterProtocol::EmptyCart:   return "cart is empty";
+    case CounterProtocol::BadRequest:  return "bad request";
+    default:                           return "server unavailable";
+    }
+}
+
+// Terminal billing counter: reads commands from stdin until EOF or "quit"
+static int runCounter(const QString &serverName) {
+    CounterClient client;
+    if(!client.connectTo(serverName)) {
+        out() << "Cannot reach medstore-server '" << serverName << "': " << client.errorString() << Qt::endl;
+        return 1;
+    }
+    out() << "Connected. Commands: add <id> [qty] | remove <id> [qty] | price <id> | checkout | cancel | quit" << Qt::endl;
+
+    QTextStream in(stdin);
+    while(!in.atEnd()) {
+        const QStringList words = in.readLine().simplified().split(' ', Qt::SkipEmptyParts);
+        if(words.isEmpty()) continue;
+        const QString cmd = words.at(0);
+        int id = words.size() > 1 ? words.at(1).toInt() : 0;
+        int qty = words.size() > 2 ? words.at(2).toInt() : 0;
+
+        CounterProtocol::Reply reply;
+        if(cmd == "quit") break;
+        else if(cmd == "add") reply = client.reserve(id, qty > 0 ? qty : 1);
+        else if(cmd == "remove") reply = client.release(id, qty);
+        else if(cmd == "price") reply = client.lookup(id);
+        else if(cmd == "cancel") reply = client.cancel();
+        else if(cmd == "checkout") {
+            reply = client.checkout();
+            if(reply.status == CounterProtocol::Ok) {
+                for(const auto &c : reply.lines) out() << QString("%1 %2 x%3\n").arg(c.name.left(24), -24).arg(formatRupees(c.unitPaisa), 8).arg(c.qty);
+                out() << "TOTAL Rs " << formatRupees(reply.totalPaisa) << "  " << reply.time.toString("yyyy-MM-dd HH:mm:ss") << Qt::endl;
+                continue;
+            }
+        } else {
+            out() << "Unknown command" << Qt::endl;
+            continue;
+        }
+
+        out() << statusText(reply.status);
+        if(!reply.name.isEmpty()) out() << "  " << reply.name << "  Rs " << formatRupees(reply.unitPaisa)
+                                      << "  available " << reply.available << "  in cart " << reply.inCart;
+        out() << Qt::endl;
+        if(reply.status == CounterProtocol::Unavailable) return 1;
+    }
+    client.disconnect();
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("medstore-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Medical Store batch tool");
+    parser.addHelpOption();
+    parser.addOption({{"d", "data-dir"}, "Directory holding medicines.inv and sales/.", "dir", "."});
+    parser.addOption({"profile", "Print latency percentiles of the instrumented paths on exit."});
+    parser.addOption({"trace", "Record spans and write them as Chrome trace-event JSON on exit.", "file"});
+    parser.addOption({"receipt-template", "Receipt layout template for reprint and export-receipts.", "file"});
+    parser.addPositionalArgument("command", "import <file.csv> | export <file.csv> | expiring [days] | reorder | valuation [top] | stats | "
+                                            "reprint <number> [text|pdf|escpos] | export-receipts <file> [text|pdf|escpos] [from] [to] | counter [server-name]");
+    parser.process(app);
+    if(parser.isSet("trace")) Profiler::setTracing(true);
+    else if(parser.isSet("profile")) Profiler::setEnabled(true);
+
+    const QStringList args = parser.positionalArguments();
+    if(args.isEmpty()) parser.showHelp(1);
+    // A counter talks to the server, which owns the data directory
+    if(args.at(0) == "counter" && args.size() <= 2) return runCounter(args.size() == 2 ? args.at(1) : QString("medstore"));
+
+    QString templateSource = QString::fromLatin1(ReceiptTemplate::DEFAULT);
+    if(parser.isSet("receipt-template")) {
+        QFile file(parser.value("receipt-template"));
+        if(!file.open(QIODevice::ReadOnly)) {
+            out() << "Cannot read " << file.fileName() << Qt::endl;
+            return 1;
+        }
+        templateSource = QString::fromUtf8(file.readAll());
+    }
+    const ReceiptTemplate layout(templateSource);
+    if(!layout.isValid()) {
+        out() << "Receipt template: " << layout.errorString() << Qt::endl;
+        return 1;
+    }
+
+    StoreCore core(parser.value("data-dir"));
+    if(!core.open()) {
+        out() << "Cannot open data in " << parser.value("data-dir") << ": " << core.errorString() << Qt::endl;
+        return 1;
+    }
+    for(const QString &item : core.unreadableExpiries()) out() << "Loaded without expiry (old date unreadable): " << item << Qt::endl;
+
+    ReceiptSpooler spooler(core.dataPath("receipts"));
+    spooler.setTemplate(templateSource);
+
+    int rc = 1;
+    const QString command = args.at(0);
+    if(command == "import" && args.size() == 2) rc = importCsv(core, args.at(1));
+    else if(command == "export" && args.size() == 2) rc = exportCsv(core, args.at(1));
+    else if(command == "expiring" && args.size() <= 2) {
+        int days = args.size() == 2 ? args.at(1).toInt() : 30;
+        for(const auto &lot : core.expiringWithin(days)) {
+            const auto m = core.inventory().find(lot.id);
+            out() << formatExpiry(lot.expiry) << "  " << lot.qty << "  " << lot.id << "  " << (m ? m->name : QString()) << "\n";
+        }
+        out().flush();
+        rc = 0;
+    } else if(command == "reorder" && args.size() == 1) {
+        const QMap<QString, QVector<int>> groups = core.inventory().reorderByCompany();
+        for(auto it = groups.cbegin(); it != groups.cend(); ++it) {
+            out() << (it.key().isEmpty() ? QString("(no company)") : it.key()) << "\n";
+            for(int id : it.value()) {
+                const auto m = core.inventory().find(id);
+                out() << "  " << id << "  " << m->name << "  stock " << m->stock << "/" << m->reorderLevel << "  order " << m->reorderQuantity() << "\n";
+            }
+        }
+        out().flush();
+        rc = 0;
+    } else if(command == "valuation" && args.size() <= 2) {
+        const int top = args.size() == 2 ? args.at(1).toInt() : 10;
+        const InventoryAnalytics::Report r = InventoryAnalytics::compute(core.inventory());
+        out() << "Stock value: Rs " << formatRupees(r.total.valuePaisa) << " (" << r.total.units << " units, "
+              << r.total.items << " SKUs) in " << QString::number(r.elapsedNs / 1e6, 'f', 1) << " ms\n";
+        out() << "\nTop companies by value:\n";
+        for(int i=0; i<qMin(top, int(r.byCompany.size())); ++i) {
+            const auto &c = r.byCompany[i];
+            out() << QString("%1 %2 %3 Rs %4\n").arg(c.company.left(24), -24).arg(c.totals.items, 7)
+                         .arg(c.totals.units, 10).arg(formatRupees(c.totals.valuePaisa), 16);
+        }
+        out() << "\nAging by expiry:\n";
+        for(int a=0; a<InventoryAnalytics::AgeBucketCount; ++a) {
+            out() << QString("%1 %2 %3 Rs %4\n").arg(InventoryAnalytics::bucketLabel(InventoryAnalytics::AgeBucket(a)), -24)
+                         .arg(r.aging[a].items, 7).arg(r.aging[a].units, 10).arg(formatRupees(r.aging[a].valuePaisa), 16);
+        }
+        out().flush();
+        rc = 0;
+    } else if(command == "reprint" && (args.size() == 2 || args.size() == 3)) {
+        ReceiptSpooler::Format format = ReceiptSpooler::PlainText;
+        Receipt receipt;
+        if(args.size() == 3 && !ReceiptSpooler::parseFormat(args.at(2), &format)) {
+            out() << "Unknown format " << args.at(2) << Qt::endl;
+        } else if(!core.receiptArchive().read(args.at(1).toUInt(), &receipt)) {
+            out() << "No receipt " << args.at(1) << Qt::endl;
+        } else {
+            QByteArray text;
+            layout.render(receipt, text);
+            QFile stdoutFile;
+            stdoutFile.open(stdout, QIODevice::WriteOnly);
+            stdoutFile.write(ReceiptSpooler::encode(format, text));
+            rc = 0;
+        }
+    } else if(command == "export-receipts" && args.size() >= 2 && args.size() <= 5) {
+        // Dates are inclusive; without them every receipt is exported
+        ReceiptSpooler::Format format = ReceiptSpooler::PlainText;
+        const QDate first = args.size() >= 4 ? QDate::fromString(args.at(3), Qt::ISODate) : QDate(1970, 1, 1);
+        const QDate last = args.size() == 5 ? QDate::fromString(args.at(4), Qt::ISODate) : QDate::currentDate().addYears(100);
+        if(args.size() >= 3 && !ReceiptSpooler::parseFormat(args.at(2), &format)) {
+            out() << "Unknown format " << args.at(2) << Qt::endl;
+        } else if(!first.isValid() || !last.isValid()) {
+            out() << "Dates are yyyy-MM-dd" << Qt::endl;
+        } else {
+            QElapsedTimer timer;
+            timer.start();
+            QObject::connect(&spooler, &ReceiptSpooler::exported, [&](bool ok, int count, const QString &message) {
+                if(ok) out() << "Exported " << count << " receipt(s) to " << message << " in " << timer.elapsed() << " ms" << Qt::endl;
+                else out() << "Export failed: " << message << Qt::endl;
+                rc = ok ? 0 : 1;
+            });
+            spooler.exportRange(first.startOfDay(), last.addDays(1).startOfDay(), format, args.at(1));
+        }
+    } else if(command == "stats") {
+        const InventoryStore::MemoryUsage usage = core.inventory().memoryUsage();
+        out() << "Medicines: " << core.inventory().size() << "\nCompanies: " << core.inventory().companyCount()
+              << "\nLow stock: " << core.inventory().lowStockCount() << "\nSales lines: " << core.ledger().size()
+              << "\nReceipts: " << core.receiptArchive().size() << " (" << core.receiptArchive().dataSize() / 1024 << " KB)"
+              << QString("\nMemory: %1 KB (columns %2, names %3, companies %4, lots %5, indexes %6)")
+                     .arg(usage.total() / 1024).arg(usage.columns / 1024).arg(usage.names / 1024)
+                     .arg(usage.companies / 1024).arg(usage.lots / 1024).arg(usage.indexes / 1024) << Qt::endl;
+        rc = 0;
+    } else parser.showHelp(1);
+
+    if(!core.flush()) {
+        out() << core.errorString() << Qt::endl;
+        rc = 1;
+    }
+    finishProfile(parser);
+    return rc;
+}
@@ -0,0 +1,235 @@
+#include "backupengine.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <array>
+
+// Content-defined chunks: 16 KiB to 256 KiB, about 64 KiB on average
+static const qint64 MIN_CHUNK = 16 * 1024;
+static const qint64 MAX_CHUNK = 256 * 1024;
+static const quint64 CUT_MASK = (quint64(1) << 16) - 1;
+static const QByteArray MANIFEST_HEADER = "MSBACKUP 1\n";
+
+// Fixed pseudo-random value per byte, so cut points are the same in
+// every run and every build
+static const std::array<quint64, 256> &gearTable() {
+    static const std::array<quint64, 256> table = []() {
+        std::array<quint64, 256> t{};
+        quint64 x = 0x9E3779B97F4A7C15ull;
+        for(int i=0; i<256; ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            t[i] = x;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// Length of the chunk starting at 'data'. The cut falls where a rolling
+// gear hash of the last 64 bytes hits the mask, so an insert only moves
+// the boundaries next to it and the chunks after it are stored again
+// unchanged. 'n' holds at least MAX_CHUNK bytes unless the file ends.
+static qint64 nextCut(const char *data, qint64 n) {
+    if(n <= MIN_CHUNK) return n;
+    const std::array<quint64, 256> &gear = gearTable();
+    const qint64 limit = qMin(n, MAX_CHUNK);
+    quint64 hash = 0;
+    for(qint64 i=MIN_CHUNK; i<limit; ++i) {
+        hash = (hash << 1) + gear[uchar(data[i])];
+        if(!(hash & CUT_MASK)) return i + 1;
+    }
+    return limit;
+}
+
+// --- BACKUP ENGINE ---
+BackupEngine::BackupEngine(const QString &dir, QObject *parent) : QObject(parent), rootDir(dir) {
+    retention.insert("Auto", 10);
+    retention.insert("Manual", 30);
+}
+
+void BackupEngine::setRetention(const QString &type, int keep) {
+    retention.insert(type, keep);
+}
+
+QStringList BackupEngine::manifests() const {
+    // Names start with a sortable timestamp, so reverse order is newest first
+    return QDir(rootDir + "/manifests").entryList({"*.manifest"}, QDir::Files, QDir::Name | QDir::Reversed);
+}
+
+QString BackupEngine::latestManifest(const QString &type) const {
+    for(const QString &name : manifests()) {
+        if(name.endsWith("_" + type + ".manifest")) return name;
+    }
+    return QString();
+}
+
+QString BackupEngine::chunkPath(const QByteArray &hex) const {
+    return rootDir + "/chunks/" + QString::fromLatin1(hex.left(2)) + "/" + QString::fromLatin1(hex);
+}
+
+bool BackupEngine::storeChunk(const QByteArray &data, QByteArray &hex) {
+    hex = QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+    QString path = chunkPath(hex);
+    if(QFile::exists(path)) return true;
+
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    file.write(qCompress(data, 1));
+    return file.commit();
+}
+
+QByteArray BackupEngine::loadChunk(const QByteArray &hex, bool *ok) const {
+    QFile file(chunkPath(hex));
+    QByteArray data;
+    if(file.open(QIODevice::ReadOnly)) data = qUncompress(file.readAll());
+    *ok = !data.isEmpty() && QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex() == hex;
+    return data;
+}
+
+void BackupEngine::backup(const QString &type, const QVector<BackupEngine::Source> &files) {
+    QDir().mkpath(rootDir + "/chunks");
+    QDir().mkpath(rootDir + "/manifests");
+
+    qint64 total = 0, done = 0;
+    for(const Source &source : files) total += source.size;
+
+    QByteArray body;
+    for(const Source &source : files) {
+        QFile file(source.path);
+        if(!file.exists()) continue;
+        if(!file.open(QIODevice::ReadOnly)) { emit backupFinished(false, type, QString()); return; }
+
+        QCryptographicHash whole(QCryptographicHash::Sha256);
+        QByteArray chunks;
+        qint64 size = 0, left = source.size;
+        QByteArray buffer;
+        while(true) {
+            if(buffer.size() < MAX_CHUNK && left > 0) {
+                const QByteArray more = file.read(qMin(MAX_CHUNK - buffer.size(), left));
+                left = more.isEmpty() ? 0 : left - more.size();
+                buffer += more;
+            }
+            if(buffer.isEmpty()) break;
+            const QByteArray data = buffer.left(nextCut(buffer.constData(), buffer.size()));
+            buffer.remove(0, data.size());
+            QByteArray hex;
+            if(!storeChunk(data, hex)) { emit backupFinished(false, type, QString()); return; }
+            whole.addData(data);
+            chunks += "chunk " + hex + "\n";
+            size += data.size();
+            done += data.size();
+            emit progress(done, qMax(done, total));
+        }
+        body += "file " + source.name.toUtf8() + " " + QByteArray::number(size) + " " + whole.result().toHex() + "\n";
+        body += chunks;
+    }
+
+    // Nothing changed since the last backup of this type
+    QString latest = latestManifest(type);
+    if(!latest.isEmpty()) {
+        QFile prev(rootDir + "/manifests/" + latest);
+        if(prev.open(QIODevice::ReadOnly)) {
+            prev.readLine(); prev.readLine();
+            if(prev.readAll() == body) { emit backupFinished(true, type, latest); return; }
+        }
+    }
+
+    QDateTime now = QDateTime::currentDateTime();
+    QString name = now.toString("yyyyMMdd_HHmmss_zzz") + "_" + type + ".manifest";
+    QSaveFile manifest(rootDir + "/manifests/" + name);
+    bool ok = manifest.open(QIODevice::WriteOnly);
+    if(ok) {
+        manifest.write(MANIFEST_HEADER);
+        manifest.write("created " + now.toString(Qt::ISODate).toUtf8() + "\n");
+        manifest.write(body);
+        ok = manifest.commit();
+    }
+
+    if(ok) {
+        applyRetention(type);
+        sweepChunks();
+    }
+    emit backupFinished(ok, type, ok ? name : QString());
+}
+
+void BackupEngine::restore(const QString &manifest, const QString &targetDir) {
+    QFile file(rootDir + "/manifests/" + manifest);
+    if(!file.open(QIODevice::ReadOnly) || file.readLine() != MANIFEST_HEADER) {
+        emit restoreFinished(false, "Cannot read " + manifest);
+        return;
+    }
+    QList<QByteArray> lines = file.readAll().split('\n');
+    QDir().mkpath(targetDir);
+
+    qint64 total = 0, done = 0;
+    for(const QByteArray &line : lines) {
+        if(line.startsWith("file ")) total += line.split(' ').value(2).toLongLong();
+    }
+
+    for(int i=0; i<lines.size(); ++i) {
+        QList<QByteArray> parts = lines[i].split(' ');
+        if(parts.value(0) != "file" || parts.size() != 4) continue;
+        QString name = QString::fromUtf8(parts[1]);
+        qint64 size = parts[2].toLongLong();
+        if(QDir::isAbsolutePath(name) || name.split('/').contains("..")) {
+            emit restoreFinished(false, "Bad file name " + name);
+            return;
+        }
+
+        QDir().mkpath(QFileInfo(targetDir + "/" + name).path());
+        QSaveFile out(targetDir + "/" + name);
+        if(!out.open(QIODevice::WriteOnly)) { emit restoreFinished(false, "Cannot write " + name); return; }
+        QCryptographicHash whole(QCryptographicHash::Sha256);
+        qint64 written = 0;
+        while(i + 1 < lines.size() && lines[i + 1].startsWith("chunk ")) {
+            bool ok;
+            QByteArray data = loadChunk(lines[++i].mid(6), &ok);
+            if(!ok) { out.cancelWriting(); emit restoreFinished(false, "Damaged chunk in " + name); return; }
+            whole.addData(data);
+            out.write(data);
+            written += data.size();
+            done += data.size();
+            emit progress(done, qMax(done, total));
+        }
+        if(written != size || whole.result().toHex() != parts[3]) {
+            out.cancelWriting();
+            emit restoreFinished(false, "Verification failed for " + name);
+            return;
+        }
+        if(!out.commit()) { emit restoreFinished(false, "Cannot write " + name); return; }
+    }
+    emit restoreFinished(true, manifest);
+}
+
+void BackupEngine::applyRetention(const QString &type) {
+    int keep = retention.value(type, 10);
+    int seen = 0;
+    for(const QString &name : manifests()) {
+        if(!name.endsWith("_" + type + ".manifest")) continue;
+        if(++seen > keep) QFile::remove(rootDir + "/manifests/" + name);
+    }
+}
+
+void BackupEngine::sweepChunks() {
+    QSet<QByteArray> live;
+    for(const QString &name : manifests()) {
+        QFile file(rootDir + "/manifests/" + name);
+        if(!file.open(QIODevice::ReadOnly)) return; // never sweep on a partial view
+        for(const QByteArray &line : file.readAll().split('\n')) {
+            if(line.startsWith("chunk ")) live.insert(line.mid(6));
+        }
+    }
+    QDirIterator it(rootDir + "/chunks", QDir::Files, QDirIterator::Subdirectories);
+    while(it.hasNext()) {
+        QString path = it.next();
+        if(!live.contains(it.fileName().toLatin1())) QFile::remove(path);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef BACKUPENGINE_H
+#define BACKUPENGINE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// --- BACKUP ENGINE ---
+// Content-addressed, deduplicated backups. Each file is cut into
+// content-defined chunks (a rolling hash picks the boundaries, so data
+// shifted by an insert still yields the same chunks) stored once under
+// <dir>/chunks by their SHA-256, and a backup is a small text manifest
+// under <dir>/manifests listing the chunks of every file. Only chunks that changed since any earlier backup
+// are written, and a backup identical to the previous one of the same
+// type is skipped. Old manifests beyond the retention limit are dropped
+// and unreferenced chunks are swept.
+//
+// Meant to live on a worker thread; call the slots through queued
+// connections and watch the signals.
+class BackupEngine : public QObject {
+    Q_OBJECT
+
+public:
+    // A file to back up under 'name', a relative path that restore()
+    // recreates. Only its first 'size' bytes are read, so append-only
+    // files (journal, sales ledger, receipt archive) are copied as they
+    // stood when the backup was requested, while writers carry on.
+    struct Source {
+        QString path;
+        QString name;
+        qint64 size;
+    };
+
+    explicit BackupEngine(const QString &dir, QObject *parent = nullptr);
+
+    void setRetention(const QString &type, int keep);
+    QStringList manifests() const;
+
+public slots:
+    void backup(const QString &type, const QVector<BackupEngine::Source> &files);
+    // Rebuilds every file of 'manifest' into 'targetDir', verifying each
+    // chunk and the whole-file hash before anything is written in place.
+    void restore(const QString &manifest, const QString &targetDir);
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void backupFinished(bool ok, const QString &type, const QString &manifest);
+    void restoreFinished(bool ok, const QString &message);
+
+private:
+    QString rootDir;
+    QHash<QString, int> retention;
+
+    QString chunkPath(const QByteArray &hex) const;
+    bool storeChunk(const QByteArray &data, QByteArray &hex);
+    QByteArray loadChunk(const QByteArray &hex, bool *ok) const;
+    QString latestManifest(const QString &type) const;
+    void applyRetention(const QString &type);
+    void sweepChunks();
+};
+
+#endif // BACKUPENGINE_H
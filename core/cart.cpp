@@ -0,0 +1,48 @@
+#include "cart.h"
+
+// --- CART ---
+int Cart::quantityOf(int id) const {
+    int row = rowOf(id);
+    return row < 0 ? 0 : items[row].qty;
+}
+
+int Cart::add(int id, const QString &name, qint64 unitPaisa, int qty, bool *created) {
+    int row = rowOf(id);
+    if(created) *created = row < 0;
+    if(row < 0) {
+        row = items.size();
+        rows.insert(id, row);
+        items.append({id, name, unitPaisa, qty});
+    } else {
+        items[row].qty += qty;
+    }
+    totalPaisa += items[row].unitPaisa * qty;
+    return row;
+}
+
+void Cart::setQuantity(int row, int qty) {
+    if(row < 0 || row >= items.size()) return;
+    if(qty <= 0) { removeAt(row); return; }
+    totalPaisa += items[row].unitPaisa * (qty - items[row].qty);
+    items[row].qty = qty;
+}
+
+void Cart::removeAt(int row) {
+    if(row < 0 || row >= items.size()) return;
+    totalPaisa -= items[row].lineTotal();
+    rows.remove(items[row].medId);
+    items.removeAt(row);
+    for(int i=row; i<items.size(); ++i) rows[items[i].medId] = i;
+}
+
+void Cart::clear() {
+    items.clear();
+    rows.clear();
+    totalPaisa = 0;
+}
+
+void Cart::swap(Cart &other) noexcept {
+    items.swap(other.items);
+    rows.swap(other.rows);
+    std::swap(totalPaisa, other.totalPaisa);
+}
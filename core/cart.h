@@ -0,0 +1,39 @@
+#ifndef CART_H
+#define CART_H
+
+#include <QVector>
+#include <QHash>
+#include "medicine.h"
+
+// --- CART ---
+// One customer's cart: lines in the order they were added, an id -> row
+// index and a running total in paisa. Adding to or changing a line and
+// reading the total are O(1); removing a line re-indexes the rows after
+// it. Swapping two carts (parking) is O(1) as well.
+class Cart {
+public:
+    const QVector<CartItem> &lines() const { return items; }
+    int size() const { return items.size(); }
+    bool isEmpty() const { return items.isEmpty(); }
+    const CartItem &at(int row) const { return items[row]; }
+    int rowOf(int id) const { return rows.value(id, -1); }
+    int quantityOf(int id) const;
+    qint64 total() const { return totalPaisa; }
+
+    // Adds qty to the item's line, creating it at the end if needed.
+    // Returns the row; 'created' tells whether the line is new.
+    int add(int id, const QString &name, qint64 unitPaisa, int qty, bool *created = nullptr);
+    // A quantity of 0 or less removes the line
+    void setQuantity(int row, int qty);
+    void removeAt(int row);
+    void clear();
+
+    void swap(Cart &other) noexcept;
+
+private:
+    QVector<CartItem> items;
+    QHash<int, int> rows;
+    qint64 totalPaisa = 0;
+};
+
+#endif // CART_H
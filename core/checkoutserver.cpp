@@ -0,0 +1,252 @@
+#include "checkoutserver.h"
+#include "counterprotocol.h"
+#include "cart.h"
+#include "profiler.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <functional>
+
+using CounterProtocol::Request;
+using CounterProtocol::Reply;
+
+// Sales arriving within this window share one journal/ledger flush
+static const int BATCH_MS = 20;
+// How long close() lets each counter take its last replies
+static const int DRAIN_TIMEOUT_MS = 1000;
+
+namespace {
+class CounterListener : public QLocalServer {
+public:
+    using QLocalServer::QLocalServer;
+    std::function<void(quintptr)> onConnection;
+
+protected:
+    void incomingConnection(quintptr descriptor) override { onConnection(descriptor); }
+};
+}
+
+// --- COUNTER CONNECTION ---
+// One billing counter. Lives on a worker thread and owns the counter's
+// cart; every line in the cart is backed by a reservation.
+class CounterConnection : public QObject {
+public:
+    explicit CounterConnection(CheckoutServer *server) : server(server) {}
+
+    void start(quintptr descriptor) {
+        socket = new QLocalSocket(this);
+        connect(socket, &QLocalSocket::readyRead, this, [this]() {
+            buffer += socket->readAll();
+            process();
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this]() { drop(); });
+        if(!socket->setSocketDescriptor(descriptor)) drop();
+    }
+
+    // Called on this thread once the batch holding our sale is on disk
+    void finishCheckout(const Reply &reply) {
+        awaitingCommit = false;
+        if(closing) { deleteLater(); return; }
+        send(reply);
+        process();
+    }
+
+    // Called on this thread while the server closes, after every reply
+    // queued so far, to push them out before the thread stops
+    void drain() {
+        if(!socket || socket->state() != QLocalSocket::ConnectedState) return;
+        socket->flush();
+        if(socket->bytesToWrite() > 0) socket->waitForBytesWritten(DRAIN_TIMEOUT_MS);
+    }
+
+private:
+    CheckoutServer *server;
+    QLocalSocket *socket = nullptr;
+    QByteArray buffer;
+    Cart cart;
+    bool awaitingCommit = false;
+    bool closing = false;
+
+    void send(const Reply &reply) { socket->write(CounterProtocol::frame(reply)); }
+
+    // Requests are answered in order; a pending checkout holds back the
+    // rest until its reply has been sent.
+    void process() {
+        while(!awaitingCommit && !closing) {
+            Request request;
+            bool bad = false;
+            if(!CounterProtocol::takeFrame(buffer, request, &bad)) {
+                if(bad) socket->abort();
+                return;
+            }
+            if(bad) {
+                Reply reply;
+                reply.status = CounterProtocol::BadRequest;
+                send(reply);
+                continue;
+            }
+            handle(request);
+        }
+    }
+
+    void handle(const Request &request) {
+        StockReservations &stock = server->stock;
+        Reply reply;
+        reply.id = request.id;
+        switch(request.op) {
+        case CounterProtocol::Lookup:
+            if(!stock.lookup(request.id, &reply.name, &reply.unitPaisa, &reply.available)) reply.status = CounterProtocol::NotFound;
+            break;
+        case CounterProtocol::Reserve:
+            if(request.qty <= 0) { reply.status = CounterProtocol::BadRequest; break; }
+            if(!stock.lookup(request.id, &reply.name, &reply.unitPaisa, nullptr)) { reply.status = CounterProtocol::NotFound; break; }
+            if(stock.reserve(request.id, request.qty)) cart.add(request.id, reply.name, reply.unitPaisa, request.qty);
+            else reply.status = CounterProtocol::OutOfStock;
+            reply.available = stock.available(request.id);
+            break;
+        case CounterProtocol::Release: {
+            // qty <= 0 releases the whole line
+            int row = cart.rowOf(request.id);
+            if(row < 0) { reply.status = CounterProtocol::NotFound; break; }
+            int inCart = cart.at(row).qty;
+            int qty = request.qty <= 0 ? inCart : qMin(int(request.qty), inCart);
+            stock.release(request.id, qty);
+            cart.setQuantity(row, inCart - qty);
+            stock.lookup(request.id, &reply.name, &reply.unitPaisa, &reply.available);
+            break;
+        }
+        case CounterProtocol::Cancel:
+            for(const auto &c : cart.lines()) stock.release(c.medId, c.qty);
+            reply.lines = cart.lines();
+            cart.clear();
+            break;
+        case CounterProtocol::Checkout: {
+            if(cart.isEmpty()) { reply.status = CounterProtocol::EmptyCart; break; }
+            awaitingCommit = true;
+            QVector<CartItem> lines = cart.lines();
+            cart.clear();
+            QMetaObject::invokeMethod(server, [server = server, self = this, lines]() { server->submit(self, lines); });
+            return;
+        }
+        default:
+            reply.status = CounterProtocol::BadRequest;
+        }
+        reply.inCart = cart.quantityOf(request.id);
+        send(reply);
+    }
+
+    void drop() {
+        if(closing) return;
+        closing = true;
+        for(const auto &c : cart.lines()) server->stock.release(c.medId, c.qty);
+        cart.clear();
+        // A sale in flight still needs this object for its reply
+        if(!awaitingCommit) deleteLater();
+    }
+};
+
+// --- CHECKOUT SERVER ---
+CheckoutServer::CheckoutServer(StoreCore &core, QObject *parent) : QObject(parent), core(core) {
+    batchTimer.setSingleShot(true);
+    batchTimer.setInterval(BATCH_MS);
+    connect(&batchTimer, &QTimer::timeout, this, &CheckoutServer::commitBatch);
+}
+
+CheckoutServer::~CheckoutServer() {
+    close();
+}
+
+bool CheckoutServer::listen(const QString &name, int workerCount) {
+    close();
+    stock.load(core.inventory());
+
+    auto *counters = new CounterListener(this);
+    counters->onConnection = [this](quintptr descriptor) { accept(descriptor); };
+    counters->setSocketOptions(QLocalServer::UserAccessOption);
+    if(!counters->listen(name) && counters->serverError() == QAbstractSocket::AddressInUseError) {
+        // A server that crashed leaves its socket file behind
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if(!probe.waitForConnected(500)) {
+            QLocalServer::removeServer(name);
+            counters->listen(name);
+        }
+    }
+    if(!counters->isListening()) {
+        error = counters->errorString();
+        delete counters;
+        return false;
+    }
+    listener = counters;
+
+    int n = workerCount > 0 ? workerCount : qMax(1, QThread::idealThreadCount());
+    for(int i=0; i<n; ++i) {
+        QThread *thread = new QThread;
+        thread->start();
+        workers.append(thread);
+    }
+    return true;
+}
+
+void CheckoutServer::close() {
+    batchTimer.stop();
+    commitBatch();
+    delete listener;
+    listener = nullptr;
+    // The last batch's replies are queued to the connections; a blocking
+    // drain on each worker runs behind them, so they are written before
+    // the threads quit and no counter is left waiting for a sale we kept
+    emit drainRequested(QPrivateSignal());
+    for(QThread *thread : workers) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+    workers.clear();
+}
+
+void CheckoutServer::accept(quintptr descriptor) {
+    QThread *thread = workers[nextWorker++ % workers.size()];
+    auto *connection = new CounterConnection(this);
+    connection->moveToThread(thread);
+    connect(thread, &QThread::finished, connection, &QObject::deleteLater);
+    connect(this, &CheckoutServer::drainRequested, connection, [connection]() { connection->drain(); }, Qt::BlockingQueuedConnection);
+    QMetaObject::invokeMethod(connection, [connection, descriptor]() { connection->start(descriptor); });
+}
+
+void CheckoutServer::submit(CounterConnection *connection, const QVector<CartItem> &lines) {
+    if(workers.isEmpty()) return; // closed; the connection is gone
+    pending.append({lines, connection});
+    if(!batchTimer.isActive()) batchTimer.start();
+}
+
+void CheckoutServer::commitBatch() {
+    if(pending.isEmpty()) return;
+    Profiler::ScopedTimer timer(Profiler::ServerCommit);
+    QVector<PendingSale> batch;
+    batch.swap(pending);
+
+    QVector<Reply> replies(batch.size());
+    for(int i=0; i<batch.size(); ++i) {
+        StoreCore::Sale sale;
+        StoreCore::Result result = core.recordSale(batch[i].lines, &sale);
+        Reply &reply = replies[i];
+        if(result == StoreCore::Ok) {
+            reply.time = sale.time;
+            reply.totalPaisa = sale.totalPaisa;
+            reply.lines = sale.lines;
+            ++committed;
+        } else {
+            // Only reachable if the store changed under the server
+            for(const auto &c : batch[i].lines) stock.release(c.medId, c.qty);
+            reply.status = result == StoreCore::OutOfStock ? CounterProtocol::OutOfStock : CounterProtocol::NotFound;
+        }
+    }
+    core.flush();
+
+    for(int i=0; i<batch.size(); ++i) {
+        CounterConnection *connection = batch[i].connection;
+        QMetaObject::invokeMethod(connection, [connection, reply = replies[i]]() { connection->finishCheckout(reply); });
+    }
+    emit batchCommitted(batch.size());
+}
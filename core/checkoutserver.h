@@ -0,0 +1,72 @@
+#ifndef CHECKOUTSERVER_H
+#define CHECKOUTSERVER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "stockreservations.h"
+#include "storecore.h"
+
+class QThread;
+class QLocalServer;
+class CounterConnection;
+
+// --- CHECKOUT SERVER ---
+// Local inventory service for several billing counters (see
+// CounterProtocol). Counter connections are spread over a pool of worker
+// threads. Adding an item to a counter's cart reserves the stock at once
+// through StockReservations, so two counters can never sell the same unit
+// and a checkout only converts reservations that are already held.
+//
+// Checkouts are handed to the thread that owns the StoreCore and committed
+// in batches: every sale that arrives within one batch window is recorded,
+// then the journal, ledger and receipt archive are fsynced once and every
+// counter in the batch gets its reply. A counter's reservations are released if it
+// disconnects or cancels.
+//
+// While the server runs it is the only writer of the data directory.
+class CheckoutServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CheckoutServer(StoreCore &core, QObject *parent = nullptr);
+    ~CheckoutServer();
+
+    // 'workerCount' <= 0 uses one thread per core
+    bool listen(const QString &name, int workerCount = 0);
+    void close();
+    QString errorString() const { return error; }
+
+    const StockReservations &reservations() const { return stock; }
+    quint64 committedSales() const { return committed; }
+    void setBatchInterval(int msec) { batchTimer.setInterval(msec); }
+
+signals:
+    void batchCommitted(int sales);
+    // Emitted by close(); each connection flushes its socket on its thread
+    void drainRequested(QPrivateSignal);
+
+private:
+    friend class CounterConnection;
+
+    struct PendingSale {
+        QVector<CartItem> lines;
+        CounterConnection *connection;
+    };
+
+    StoreCore &core;
+    StockReservations stock;
+    QLocalServer *listener = nullptr;
+    QVector<QThread *> workers;
+    int nextWorker = 0;
+    QVector<PendingSale> pending;
+    QTimer batchTimer;
+    quint64 committed = 0;
+    QString error;
+
+    void accept(quintptr descriptor);
+    void submit(CounterConnection *connection, const QVector<CartItem> &lines);
+    void commitBatch();
+};
+
+#endif // CHECKOUTSERVER_H
@@ -0,0 +1,14 @@
+# Links the GUI-free core library into an app or tool target
+QT += concurrent network
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+# Build directory of core/, wherever the including project sits
+CORE_BUILD_DIR = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$CORE_BUILD_DIR/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$CORE_BUILD_DIR/debug
+else: CORE_LIB_DIR = $$CORE_BUILD_DIR
+
+LIBS += -L$$CORE_LIB_DIR -lcore
+win32-g++|!win32: PRE_TARGETDEPS += $$CORE_LIB_DIR/libcore.a
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/core.lib
@@ -0,0 +1,42 @@
+QT       = core concurrent network
+TARGET = core
+TEMPLATE = lib
+CONFIG += staticlib
+SOURCES += backupengine.cpp \
+           cart.cpp \
+           checkoutserver.cpp \
+           counterclient.cpp \
+           csvio.cpp \
+           fileutil.cpp \
+           inventoryanalytics.cpp \
+           inventoryfile.cpp \
+           inventoryjournal.cpp \
+           inventorystore.cpp \
+           profiler.cpp \
+           receipt.cpp \
+           receiptarchive.cpp \
+           receiptspooler.cpp \
+           salesledger.cpp \
+           searchindex.cpp \
+           stockreservations.cpp \
+           storecore.cpp
+HEADERS += medicine.h \
+           backupengine.h \
+           cart.h \
+           checkoutserver.h \
+           counterclient.h \
+           counterprotocol.h \
+           csvio.h \
+           fileutil.h \
+           inventoryanalytics.h \
+           inventoryfile.h \
+           inventoryjournal.h \
+           inventorystore.h \
+           profiler.h \
+           receipt.h \
+           receiptarchive.h \
+           receiptspooler.h \
+           salesledger.h \
+           searchindex.h \
+           stockreservations.h \
+           storecore.h
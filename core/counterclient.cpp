@@ -0,0 +1,48 @@
+#include "counterclient.h"
+
+// --- COUNTER CLIENT ---
+bool CounterClient::connectTo(const QString &serverName, int msecs) {
+    disconnect();
+    socket.connectToServer(serverName);
+    return socket.waitForConnected(msecs);
+}
+
+void CounterClient::disconnect() {
+    if(socket.state() != QLocalSocket::UnconnectedState) {
+        socket.disconnectFromServer();
+        if(socket.state() != QLocalSocket::UnconnectedState) socket.waitForDisconnected(timeout);
+    }
+    buffer.clear();
+}
+
+CounterProtocol::Reply CounterClient::lookup(int id) { return call(CounterProtocol::Lookup, id); }
+CounterProtocol::Reply CounterClient::reserve(int id, int qty) { return call(CounterProtocol::Reserve, id, qty); }
+CounterProtocol::Reply CounterClient::release(int id, int qty) { return call(CounterProtocol::Release, id, qty); }
+CounterProtocol::Reply CounterClient::checkout() { return call(CounterProtocol::Checkout); }
+CounterProtocol::Reply CounterClient::cancel() { return call(CounterProtocol::Cancel); }
+
+CounterProtocol::Reply CounterClient::call(quint8 op, int id, int qty) {
+    CounterProtocol::Reply reply;
+    reply.status = CounterProtocol::Unavailable;
+    if(!isConnected()) return reply;
+
+    CounterProtocol::Request request;
+    request.op = op;
+    request.id = id;
+    request.qty = qty;
+    socket.write(CounterProtocol::frame(request));
+    socket.flush();
+
+    bool bad = false;
+    while(!CounterProtocol::takeFrame(buffer, reply, &bad)) {
+        if(bad || !socket.waitForReadyRead(timeout)) {
+            reply = CounterProtocol::Reply();
+            reply.status = CounterProtocol::Unavailable;
+            socket.abort();
+            return reply;
+        }
+        buffer += socket.readAll();
+    }
+    if(bad) reply.status = CounterProtocol::Unavailable;
+    return reply;
+}
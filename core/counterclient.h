@@ -0,0 +1,38 @@
+#ifndef COUNTERCLIENT_H
+#define COUNTERCLIENT_H
+
+#include <QLocalSocket>
+#include "counterprotocol.h"
+
+// --- COUNTER CLIENT ---
+// Blocking client for one billing counter talking to a CheckoutServer.
+// Each call sends one request and waits for its reply, so it needs no
+// event loop and can be driven from a terminal or a plain thread. Lost
+// connections and timeouts come back as Status Unavailable.
+class CounterClient {
+public:
+    static const int DEFAULT_TIMEOUT_MS = 5000;
+
+    bool connectTo(const QString &serverName, int msecs = DEFAULT_TIMEOUT_MS);
+    void disconnect();
+    bool isConnected() const { return socket.state() == QLocalSocket::ConnectedState; }
+    QString errorString() const { return socket.errorString(); }
+
+    CounterProtocol::Reply lookup(int id);
+    CounterProtocol::Reply reserve(int id, int qty);
+    // qty <= 0 releases the whole line
+    CounterProtocol::Reply release(int id, int qty = 0);
+    CounterProtocol::Reply checkout();
+    CounterProtocol::Reply cancel();
+
+    void setTimeout(int msecs) { timeout = msecs; }
+
+private:
+    QLocalSocket socket;
+    QByteArray buffer;
+    int timeout = DEFAULT_TIMEOUT_MS;
+
+    CounterProtocol::Reply call(quint8 op, int id = 0, int qty = 0);
+};
+
+#endif // COUNTERCLIENT_H
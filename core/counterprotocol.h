@@ -0,0 +1,85 @@
+#ifndef COUNTERPROTOCOL_H
+#define COUNTERPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QtEndian>
+#include "medicine.h"
+
+// --- COUNTER PROTOCOL ---
+// Messages between billing counters and the checkout server. Every message
+// is a frame: [quint32 little-endian length][QDataStream payload]. A
+// counter sends one Request and waits for its Reply; the server keeps the
+// counter's cart (and the stock it has reserved) for the connection.
+namespace CounterProtocol {
+
+enum Op : quint8 { Lookup = 1, Reserve = 2, Release = 3, Checkout = 4, Cancel = 5 };
+enum Status : quint8 { Ok = 0, NotFound = 1, OutOfStock = 2, EmptyCart = 3, BadRequest = 4, Unavailable = 5 };
+
+static const QDataStream::Version STREAM_VERSION = QDataStream::Qt_6_0;
+static const quint32 MAX_FRAME = 1 << 20;
+
+struct Request {
+    quint8 op = Lookup;
+    qint32 id = 0;
+    qint32 qty = 0;
+
+    friend QDataStream &operator<<(QDataStream &out, const Request &r) { return out << r.op << r.id << r.qty; }
+    friend QDataStream &operator>>(QDataStream &in, Request &r) { return in >> r.op >> r.id >> r.qty; }
+};
+
+// Lookup/Reserve/Release fill id..inCart; Checkout and Cancel return the
+// cart lines (sold or released) and, for a checkout, its time and total.
+struct Reply {
+    quint8 status = Ok;
+    qint32 id = 0;
+    QString name;
+    qint64 unitPaisa = 0;
+    qint32 available = 0;
+    qint32 inCart = 0;
+    QDateTime time;
+    qint64 totalPaisa = 0;
+    QVector<CartItem> lines;
+
+    friend QDataStream &operator<<(QDataStream &out, const Reply &r) {
+        return out << r.status << r.id << r.name << r.unitPaisa << r.available << r.inCart << r.time << r.totalPaisa << r.lines;
+    }
+    friend QDataStream &operator>>(QDataStream &in, Reply &r) {
+        return in >> r.status >> r.id >> r.name >> r.unitPaisa >> r.available >> r.inCart >> r.time >> r.totalPaisa >> r.lines;
+    }
+};
+
+template <typename T>
+QByteArray frame(const T &message) {
+    QByteArray data(4, Qt::Uninitialized);
+    QDataStream out(&data, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(STREAM_VERSION);
+    out << message;
+    qToLittleEndian<quint32>(quint32(data.size() - 4), data.data());
+    return data;
+}
+
+// Removes one complete frame from the front of 'buffer'. Returns false
+// when more data is needed; 'bad' is set for an oversized frame.
+template <typename T>
+bool takeFrame(QByteArray &buffer, T &message, bool *bad = nullptr) {
+    if(bad) *bad = false;
+    if(buffer.size() < 4) return false;
+    quint32 len = qFromLittleEndian<quint32>(buffer.constData());
+    if(len > MAX_FRAME) {
+        if(bad) *bad = true;
+        return false;
+    }
+    if(quint32(buffer.size()) - 4 < len) return false;
+    QDataStream in(buffer.mid(4, int(len)));
+    in.setVersion(STREAM_VERSION);
+    in >> message;
+    buffer.remove(0, int(len) + 4);
+    if(bad) *bad = in.status() != QDataStream::Ok;
+    return true;
+}
+
+}
+
+#endif // COUNTERPROTOCOL_H
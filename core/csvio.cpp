@@ -0,0 +1,123 @@
+#include "csvio.h"
+#include <QThread>
+#include <QtConcurrent>
+
+const QString CsvIO::HEADER = "id,name,price,stock,expiry,company,lots,reorder";
+
+// Empty means undated; anything else has to be a date
+static bool readExpiry(const QString &text, PackedDate *expiry) {
+    *expiry = parseExpiry(text);
+    return *expiry != 0 || text.trimmed().isEmpty();
+}
+
+// --- CSV IMPORT / EXPORT ---
+QStringList CsvIO::splitLine(const QString &line) {
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+    // Quoted text spans [first, last) of 'field'; -1 when nothing was quoted
+    int first = -1, last = -1;
+    auto finish = [&]() {
+        int begin = 0, end = int(field.size());
+        while(begin < end && (first < 0 || begin < first) && field.at(begin).isSpace()) ++begin;
+        while(end > begin && end > last && field.at(end - 1).isSpace()) --end;
+        fields.append(field.mid(begin, end - begin));
+        field.clear();
+        first = last = -1;
+    };
+    for(int i=0; i<line.size(); ++i) {
+        QChar c = line.at(i);
+        if(quoted) {
+            if(c == '"' && i + 1 < line.size() && line.at(i + 1) == '"') { field += '"'; ++i; }
+            else if(c == '"') { quoted = false; last = int(field.size()); }
+            else field += c;
+        } else if(c == '"') {
+            quoted = true;
+            if(first < 0) first = int(field.size());
+        } else if(c == ',') {
+            finish();
+        } else if(c != '\r') {
+            field += c;
+        }
+    }
+    finish();
+    return fields;
+}
+
+QString CsvIO::quote(const QString &field) {
+    const bool padded = !field.isEmpty() && (field.front().isSpace() || field.back().isSpace());
+    if(!padded && !field.contains(',') && !field.contains('"')) return field;
+    QString escaped = field;
+    escaped.replace("\"", "\"\"");
+    return "\"" + escaped + "\"";
+}
+
+bool CsvIO::parseMedicine(const QString &line, Medicine &m) {
+    QStringList f = splitLine(line);
+    if(f.size() < 6 || f.size() > 8) return false;
+    bool okId, okPrice, okStock;
+    m.id = f[0].trimmed().toInt(&okId);
+    m.name = f[1];
+    m.price = f[2].trimmed().toDouble(&okPrice);
+    m.stock = f[3].trimmed().toInt(&okStock);
+    if(!readExpiry(f[4], &m.expiry)) return false;
+    m.company = f[5];
+    m.lots.clear();
+    if(f.size() >= 7 && !f[6].trimmed().isEmpty()) {
+        for(const QString &pair : f[6].split(';', Qt::SkipEmptyParts)) {
+            int colon = pair.lastIndexOf(':');
+            bool okQty;
+            int qty = pair.mid(colon + 1).trimmed().toInt(&okQty);
+            Lot lot{0, qty};
+            if(colon < 0 || !okQty || !readExpiry(pair.left(colon), &lot.expiry)) return false;
+            m.lots.append(lot);
+        }
+    }
+    m.reorderLevel = Medicine::DEFAULT_REORDER_LEVEL;
+    if(f.size() == 8 && !f[7].trimmed().isEmpty()) {
+        bool okLevel;
+        m.reorderLevel = f[7].trimmed().toInt(&okLevel);
+        if(!okLevel || m.reorderLevel < 0) return false;
+    }
+    m.normalizeLots();
+    return okId && okPrice && okStock && !m.name.isEmpty();
+}
+
+QString CsvIO::formatMedicine(const Medicine &m) {
+    QStringList lots;
+    for(const Lot &l : m.lots) lots << formatExpiry(l.expiry) + ":" + QString::number(l.qty);
+    return QString::number(m.id) + "," + quote(m.name) + "," + QString::number(m.price) + ","
+           + QString::number(m.stock) + "," + formatExpiry(m.expiry) + "," + quote(m.company) + "," + lots.join(';')
+           + "," + QString::number(m.reorderLevel);
+}
+
+QVector<Medicine> CsvIO::parseParallel(const QStringList &lines, int *rejected) {
+    // One slice per core keeps the per-task overhead negligible
+    int slices = qMax(1, QThread::idealThreadCount());
+    int per = (lines.size() + slices - 1) / slices;
+    QVector<QPair<int, int>> ranges;
+    for(int begin=0; begin<lines.size(); begin+=per) ranges.append({begin, qMin(begin + per, int(lines.size()))});
+
+    struct Parsed { QVector<Medicine> records; int bad = 0; };
+    QList<Parsed> parts = QtConcurrent::blockingMapped<QList<Parsed>>(ranges, [&lines](const QPair<int, int> &r) {
+        Parsed p;
+        p.records.reserve(r.second - r.first);
+        for(int i=r.first; i<r.second; ++i) {
+            if(lines[i].trimmed().isEmpty()) continue;
+            Medicine m;
+            if(parseMedicine(lines[i], m)) p.records.append(m);
+            else ++p.bad;
+        }
+        return p;
+    });
+
+    QVector<Medicine> result;
+    result.reserve(lines.size());
+    int bad = 0;
+    for(const Parsed &p : parts) {
+        result.append(p.records);
+        bad += p.bad;
+    }
+    if(rejected) *rejected = bad;
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef CSVIO_H
+#define CSVIO_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "medicine.h"
+
+// --- CSV IMPORT / EXPORT ---
+// One medicine per line: id,name,price,stock,expiry,company[,lots[,reorder]].
+// The optional lots column lists "expiry:qty" pairs separated by ';' and,
+// when present, overrides stock/expiry. An empty or missing reorder column
+// uses the default reorder level. An expiry is either empty (undated) or a
+// date parseExpiry() accepts; anything else rejects the line. Fields may
+// be double-quoted (with "" for a literal quote) but may not span lines;
+// spaces around a field are dropped unless they are inside the quotes.
+class CsvIO {
+public:
+    static const QString HEADER;
+
+    static QStringList splitLine(const QString &line);
+    static QString quote(const QString &field);
+    static bool parseMedicine(const QString &line, Medicine &m);
+    static QString formatMedicine(const Medicine &m);
+
+    // Parses a batch of lines across all cores. Lines that fail to parse
+    // are counted in 'rejected' and skipped.
+    static QVector<Medicine> parseParallel(const QStringList &lines, int *rejected = nullptr);
+};
+
+#endif // CSVIO_H
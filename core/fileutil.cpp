@@ -0,0 +1,33 @@
+#include "fileutil.h"
+#include <array>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// --- FILE UTILITIES ---
+quint32 FileUtil::crc32(const char *data, qsizetype len) {
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> t{};
+        for(quint32 i=0; i<256; ++i) {
+            quint32 c = i;
+            for(int k=0; k<8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xFFFFFFFFu;
+    for(qsizetype i=0; i<len; ++i) crc = table[(crc ^ uchar(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool FileUtil::sync(QFile &file) {
+    if(!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
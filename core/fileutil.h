@@ -0,0 +1,18 @@
+#ifndef FILEUTIL_H
+#define FILEUTIL_H
+
+#include <QFile>
+
+// --- FILE UTILITIES ---
+// Shared by the journal, the sales ledger and the receipt archive, which
+// all checksum their records and force them to disk before acknowledging.
+class FileUtil {
+public:
+    // CRC-32 (IEEE 802.3), as used by zlib
+    static quint32 crc32(const char *data, qsizetype len);
+    // Forces written data to the disk, not just the OS cache. Flushes the
+    // QFile's own buffer first; false if either step fails.
+    static bool sync(QFile &file);
+};
+
+#endif // FILEUTIL_H
@@ -0,0 +1,267 @@
+#include "inventoryanalytics.h"
+#include "storecore.h"
+#include "profiler.h"
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <algorithm>
+
+// Slots per pass of the value kernel; the tile's values stay in L1
+static const int TILE = 1024;
+
+// --- KERNELS ---
+// Value of each slot in paisa. Straight-line over two columns so the
+// compiler can vectorize it; prices are never negative, so adding half a
+// paisa and truncating matches toPaisa().
+static void valueKernel(const double *price, const qint32 *stock, qint64 *value, int n) {
+    for(int i=0; i<n; ++i) value[i] = qint64(price[i] * 100.0 + 0.5) * stock[i];
+}
+
+// --- INVENTORY ANALYTICS ---
+InventoryAnalytics::InventoryAnalytics(StoreCore &core, QObject *parent) : QObject(parent), core(core) {
+    watcher = new QFutureWatcher<BlockTotals>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, &InventoryAnalytics::collect);
+
+    autoTimer.setSingleShot(true);
+    connect(&autoTimer, &QTimer::timeout, this, &InventoryAnalytics::refresh);
+
+    connect(&core, &StoreCore::inserted, this, &InventoryAnalytics::markSlot);
+    connect(&core, &StoreCore::changed, this, &InventoryAnalytics::markSlot);
+    connect(&core, &StoreCore::removed, this, [this](int refilledSlot) {
+        // The old last slot is gone and its record now fills the hole
+        if(refilledSlot >= 0) markSlot(refilledSlot);
+        markSlot(this->core.inventory().size());
+    });
+    connect(&core, &StoreCore::reset, this, &InventoryAnalytics::invalidateAll);
+}
+
+InventoryAnalytics::~InventoryAnalytics() {
+    running.waitForFinished();
+}
+
+bool InventoryAnalytics::isStale() const {
+    return busy || cachedAsOf != QDate::currentDate() || dirty.contains(true)
+           || blocks.size() * BLOCK_SIZE < core.inventory().size();
+}
+
+void InventoryAnalytics::markSlot(int slot) {
+    int block = slot / BLOCK_SIZE;
+    if(block >= dirty.size()) dirty.resize(block + 1, true);
+    dirty[block] = true;
+    if(autoTimer.interval() > 0) autoTimer.start();
+}
+
+void InventoryAnalytics::invalidateAll() {
+    ++generation;
+    dirty.fill(true);
+    if(autoTimer.interval() > 0) autoTimer.start();
+}
+
+void InventoryAnalytics::setAutoRefresh(int ms) {
+    autoTimer.setInterval(qMax(0, ms));
+    if(ms <= 0) autoTimer.stop();
+    else if(isStale()) autoTimer.start();
+}
+
+void InventoryAnalytics::refresh() {
+    if(busy) { refreshAgain = true; return; }
+    start();
+}
+
+void InventoryAnalytics::refreshNow() {
+    if(!busy) start();
+    while(busy) {
+        running.waitForFinished();
+        collect();
+    }
+}
+
+void InventoryAnalytics::start() {
+    const QDate today = QDate::currentDate();
+    if(today != cachedAsOf) dirty.fill(true);
+    cachedAsOf = today;
+
+    runningSnapshot = core.inventory().snapshot();
+    const int count = (runningSnapshot.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    blocks.resize(count);
+    dirty.resize(count, true);
+    runningBlocks.clear();
+    for(int b=0; b<count; ++b) {
+        if(!dirty[b]) continue;
+        runningBlocks.append(b);
+        dirty[b] = false;
+    }
+    runningAsOf = today;
+    runningGeneration = generation;
+    runningTimer.start();
+    busy = true;
+
+    if(runningBlocks.isEmpty()) {
+        running = QFuture<BlockTotals>();
+        collect();
+        return;
+    }
+    const InventoryStore snapshot = runningSnapshot;
+    const AgeLimits limits = limitsFor(today);
+    // The snapshot has no id index, so the jobs are laid out from the store
+    running = QtConcurrent::mapped(jobsFor(core.inventory(), runningBlocks), [snapshot, limits](const Job &job) {
+        return computeBlock(snapshot, job, limits);
+    });
+    watcher->setFuture(running);
+}
+
+void InventoryAnalytics::collect() {
+    if(!busy || !running.isFinished()) return;
+    busy = false;
+
+    if(runningGeneration == generation) {
+        const QList<BlockTotals> results = runningBlocks.isEmpty() ? QList<BlockTotals>() : running.results();
+        for(int i=0; i<results.size(); ++i) blocks[runningBlocks[i]] = results[i];
+        current = merge(runningSnapshot, blocks, runningAsOf);
+        current.elapsedNs = runningTimer.nsecsElapsed();
+        current.blocksComputed = runningBlocks.size();
+    } else {
+        // The store was replaced under the refresh; start over
+        refreshAgain = true;
+    }
+    // Let go of the snapshot so the next change need not copy the columns
+    runningSnapshot = InventoryStore();
+    running = QFuture<BlockTotals>();
+
+    if(refreshAgain) {
+        refreshAgain = false;
+        start();
+    }
+    if(!busy) emit updated();
+}
+
+InventoryAnalytics::AgeLimits InventoryAnalytics::limitsFor(const QDate &asOf) {
+    return {packDate(asOf), packDate(asOf.addDays(30)), packDate(asOf.addDays(90)),
+            packDate(asOf.addDays(180)), packDate(asOf.addDays(365))};
+}
+
+QVector<InventoryAnalytics::Job> InventoryAnalytics::jobsFor(const InventoryStore &store, const QVector<int> &blockIds) {
+    QVector<Job> jobs;
+    QHash<int, int> jobOfBlock;
+    for(int b : blockIds) {
+        jobOfBlock.insert(b, jobs.size());
+        jobs.append({b, {}});
+    }
+    const QHash<int, QVector<Lot>> &multi = store.multiLotRecords();
+    for(auto it = multi.cbegin(); it != multi.cend(); ++it) {
+        int slot = store.slotOf(it.key());
+        auto job = jobOfBlock.constFind(slot / BLOCK_SIZE);
+        if(job != jobOfBlock.constEnd()) jobs[job.value()].multiLotSlots.append(slot);
+    }
+    return jobs;
+}
+
+InventoryAnalytics::BlockTotals InventoryAnalytics::computeBlock(const InventoryStore &store, const Job &job, const AgeLimits &limits) {
+    Profiler::ScopedTimer timer(Profiler::AnalyticsBlock);
+    const int begin = job.block * BLOCK_SIZE, end = qMin(begin + BLOCK_SIZE, store.size());
+    const double *price = store.priceColumn();
+    const qint32 *stock = store.stockColumn();
+    const PackedDate *expiry = store.expiryColumn();
+    const quint32 *company = store.companyColumn();
+
+    BlockTotals t;
+    t.companyValue.fill(0, store.companyCount());
+    t.companyUnits.fill(0, store.companyCount());
+    t.companySkus.fill(0, store.companyCount());
+    qint64 *companyValue = t.companyValue.data(), *companyUnits = t.companyUnits.data();
+    qint32 *companySkus = t.companySkus.data();
+    qint64 ageValue[AgeBucketCount] = {}, ageUnits[AgeBucketCount] = {};
+    int ageLots[AgeBucketCount] = {};
+
+    qint64 value[TILE];
+    for(int first=begin; first<end; first+=TILE) {
+        const int n = qMin(TILE, end - first);
+        valueKernel(price + first, stock + first, value, n);
+        for(int i=0; i<n; ++i) {
+            const int slot = first + i;
+            const quint32 c = company[slot];
+            companyValue[c] += value[i];
+            companyUnits[c] += stock[slot];
+            ++companySkus[c];
+            // Every record is one lot here; multi-lot records are fixed up below
+            const int a = ageBucket(expiry[slot], limits);
+            ageValue[a] += value[i];
+            ageUnits[a] += stock[slot];
+            ageLots[a] += int(stock[slot] > 0);
+        }
+    }
+
+    for(int slot : job.multiLotSlots) {
+        const qint64 unit = qint64(price[slot] * 100.0 + 0.5);
+        const int a = ageBucket(expiry[slot], limits);
+        ageValue[a] -= unit * stock[slot];
+        ageUnits[a] -= stock[slot];
+        --ageLots[a];
+        for(const Lot &l : store.multiLotRecords().value(store.idAt(slot))) {
+            const int b = ageBucket(l.expiry, limits);
+            ageValue[b] += unit * l.qty;
+            ageUnits[b] += l.qty;
+            ++ageLots[b];
+        }
+    }
+
+    for(int a=0; a<AgeBucketCount; ++a) t.aging[a] = {ageValue[a], ageUnits[a], ageLots[a]};
+    return t;
+}
+
+InventoryAnalytics::Report InventoryAnalytics::merge(const InventoryStore &store, const QVector<BlockTotals> &blocks, const QDate &asOf) {
+    Report r;
+    r.asOf = asOf;
+    r.blockCount = blocks.size();
+    QVector<StockTotals> companies(store.companyCount());
+    for(const BlockTotals &b : blocks) {
+        const int n = qMin(int(b.companyValue.size()), int(companies.size()));
+        for(int c=0; c<n; ++c) {
+            companies[c].valuePaisa += b.companyValue[c];
+            companies[c].units += b.companyUnits[c];
+            companies[c].items += b.companySkus[c];
+        }
+        for(int a=0; a<AgeBucketCount; ++a) {
+            r.aging[a].valuePaisa += b.aging[a].valuePaisa;
+            r.aging[a].units += b.aging[a].units;
+            r.aging[a].items += b.aging[a].items;
+        }
+    }
+    for(int c=0; c<companies.size(); ++c) {
+        if(companies[c].items == 0) continue;
+        r.byCompany.append({store.companyName(c), companies[c]});
+        r.total.valuePaisa += companies[c].valuePaisa;
+        r.total.units += companies[c].units;
+        r.total.items += companies[c].items;
+    }
+    std::sort(r.byCompany.begin(), r.byCompany.end(), [](const CompanyStock &a, const CompanyStock &b) {
+        return a.totals.valuePaisa != b.totals.valuePaisa ? a.totals.valuePaisa > b.totals.valuePaisa : a.company < b.company;
+    });
+    return r;
+}
+
+InventoryAnalytics::Report InventoryAnalytics::compute(const InventoryStore &store, const QDate &asOf) {
+    QElapsedTimer timer;
+    timer.start();
+    QVector<int> all;
+    for(int b=0; b*BLOCK_SIZE<store.size(); ++b) all.append(b);
+    const AgeLimits limits = limitsFor(asOf);
+    const QVector<BlockTotals> blocks = QtConcurrent::mapped(jobsFor(store, all), [&store, limits](const Job &job) {
+        return computeBlock(store, job, limits);
+    }).results();
+    Report r = merge(store, blocks, asOf);
+    r.elapsedNs = timer.nsecsElapsed();
+    r.blocksComputed = blocks.size();
+    return r;
+}
+
+QString InventoryAnalytics::bucketLabel(AgeBucket bucket) {
+    switch(bucket) {
+    case Expired:       return "Expired";
+    case Within30Days:  return "0-30 days";
+    case Within90Days:  return "31-90 days";
+    case Within180Days: return "91-180 days";
+    case Within365Days: return "181-365 days";
+    case Beyond365Days: return "Over a year";
+    default:            return "No date";
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef INVENTORYANALYTICS_H
+#define INVENTORYANALYTICS_H
+
+#include <QObject>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QTimer>
+#include <QVector>
+#include "inventorystore.h"
+
+class StoreCore;
+template<typename T> class QFutureWatcher;
+
+// --- INVENTORY ANALYTICS ---
+// Stock valuation (price x stock, in paisa), the same rolled up per
+// company, and stock aging by expiry. The catalogue is cut into fixed
+// blocks of slots; each block is reduced on the QtConcurrent pool by
+// kernels that walk the store's price, stock, expiry and company columns
+// directly, and the block results are merged into one report.
+//
+// Block results are cached. A store change only marks the block holding
+// the affected slot (or slots, for a swap-remove) dirty, so a refresh
+// after a sale recomputes one block and re-merges the rest. Refreshes
+// read a snapshot() of the store and never block the GUI thread; a sale
+// while one runs copies the columns it touches (see InventoryStore).
+class InventoryAnalytics : public QObject {
+    Q_OBJECT
+
+public:
+    enum AgeBucket { Expired, Within30Days, Within90Days, Within180Days, Within365Days, Beyond365Days, Undated, AgeBucketCount };
+
+    // 'items' counts SKUs in company rows and lots in aging rows
+    struct StockTotals {
+        qint64 valuePaisa = 0;
+        qint64 units = 0;
+        int items = 0;
+    };
+
+    struct CompanyStock {
+        QString company;
+        StockTotals totals;
+    };
+
+    struct Report {
+        QDate asOf;
+        StockTotals total;
+        // Highest value first
+        QVector<CompanyStock> byCompany;
+        StockTotals aging[AgeBucketCount];
+        // Cost of the refresh that produced this report
+        qint64 elapsedNs = 0;
+        int blocksComputed = 0;
+        int blockCount = 0;
+    };
+
+    static const int BLOCK_SIZE = 32768;
+
+    explicit InventoryAnalytics(StoreCore &core, QObject *parent = nullptr);
+    ~InventoryAnalytics();
+
+    const Report &report() const { return current; }
+    bool isStale() const;
+    bool isRefreshing() const { return busy; }
+
+    // Recomputes the dirty blocks in the background and emits updated()
+    void refresh();
+    // Same, but blocks the caller until the report is current
+    void refreshNow();
+    // After a change, refresh on its own once 'ms' pass without another
+    // change (0 turns this off)
+    void setAutoRefresh(int ms);
+    void invalidateAll();
+
+    // One-shot report over a whole store, without caching
+    static Report compute(const InventoryStore &store, const QDate &asOf = QDate::currentDate());
+    static QString bucketLabel(AgeBucket bucket);
+
+signals:
+    void updated();
+
+private:
+    struct BlockTotals {
+        QVector<qint64> companyValue;
+        QVector<qint64> companyUnits;
+        QVector<qint32> companySkus;
+        StockTotals aging[AgeBucketCount];
+    };
+    // Bounds of the aging buckets as packed dates
+    struct AgeLimits {
+        PackedDate today, d30, d90, d180, d365;
+    };
+    struct Job {
+        int block;
+        // Slots in the block whose lots must be aged one by one
+        QVector<int> multiLotSlots;
+    };
+
+    StoreCore &core;
+    Report current;
+    QVector<BlockTotals> blocks;
+    QVector<bool> dirty;
+    QDate cachedAsOf;
+    // Bumped when the store is replaced; company indices from an older
+    // generation no longer match the dictionary
+    int generation = 0;
+    QTimer autoTimer;
+
+    QFuture<BlockTotals> running;
+    QFutureWatcher<BlockTotals> *watcher;
+    bool busy = false;
+    bool refreshAgain = false;
+    QVector<int> runningBlocks;
+    InventoryStore runningSnapshot;
+    QDate runningAsOf;
+    int runningGeneration = 0;
+    QElapsedTimer runningTimer;
+
+    static AgeLimits limitsFor(const QDate &asOf);
+    static int ageBucket(PackedDate expiry, const AgeLimits &limits) {
+        if(!expiry) return Undated;
+        // Each bound passed moves the lot one bucket further out
+        return int(expiry >= limits.today) + int(expiry > limits.d30) + int(expiry > limits.d90)
+               + int(expiry > limits.d180) + int(expiry > limits.d365);
+    }
+    static BlockTotals computeBlock(const InventoryStore &store, const Job &job, const AgeLimits &limits);
+    static Report merge(const InventoryStore &store, const QVector<BlockTotals> &blocks, const QDate &asOf);
+    static QVector<Job> jobsFor(const InventoryStore &store, const QVector<int> &blockIds);
+
+    void markSlot(int slot);
+    void start();
+    void collect();
+};
+
+#endif // INVENTORYANALYTICS_H
@@ -0,0 +1,194 @@
+#include "inventoryfile.h"
+#include "profiler.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QHash>
+#include <QtEndian>
+#include <cstring>
+
+static const char MAGIC[4] = {'M', 'S', 'I', 'V'};
+static const quint32 VERSION = 3;
+static const int HEADER_SIZE = 32;
+static const int SLOT_SIZE = 44;
+static const int SLOT_SIZE_V2 = 40;
+static const int LOT_SIZE = 8;
+// Smallest QDataStream record of the original format: id, price, stock
+// and three empty strings
+static const int LEGACY_RECORD_MIN = 28;
+
+namespace {
+struct Pool {
+    QByteArray data;
+    QHash<QString, quint32> offsets;
+
+    // Returns the offset in UTF-16 code units, reusing identical strings
+    quint32 add(const QString &s) {
+        auto found = offsets.constFind(s);
+        if(found != offsets.constEnd()) return found.value();
+        quint32 off = quint32(data.size() / 2);
+        for(QChar c : s) {
+            char le[2];
+            qToLittleEndian<quint16>(c.unicode(), le);
+            data.append(le, 2);
+        }
+        offsets.insert(s, off);
+        return off;
+    }
+};
+
+struct Decoder {
+    const uchar *pool;
+    quint64 units;
+    QHash<quint64, QString> cache;
+
+    bool valid(quint32 off, quint32 len) const { return quint64(off) + len <= units; }
+
+    QString plain(quint32 off, quint32 len) const {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        return QString(reinterpret_cast<const QChar *>(pool + off * 2), len);
+#else
+        QString s(len, Qt::Uninitialized);
+        for(quint32 i=0; i<len; ++i) s[i] = QChar(qFromLittleEndian<quint16>(pool + (off + i) * 2));
+        return s;
+#endif
+    }
+
+    // Companies repeat across thousands of records, so decode each pool
+    // entry once and let the records share it.
+    QString shared(quint32 off, quint32 len) {
+        quint64 key = (quint64(off) << 32) | len;
+        auto found = cache.constFind(key);
+        if(found != cache.constEnd()) return found.value();
+        QString s = plain(off, len);
+        cache.insert(key, s);
+        return s;
+    }
+};
+}
+
+bool InventoryFile::read(const QString &path, InventoryStore &store, QStringList *unreadable) {
+    Profiler::ScopedTimer timer(Profiler::SnapshotRead);
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE) return false;
+    uchar *base = file.map(0, file.size());
+    if(!base) return false;
+
+    const quint64 fileSize = quint64(file.size());
+    quint32 version = qFromLittleEndian<quint32>(base + 4);
+    quint32 count = qFromLittleEndian<quint32>(base + 8);
+    quint32 lotCount = version >= 2 ? qFromLittleEndian<quint32>(base + 12) : 0;
+    quint64 poolOff = qFromLittleEndian<quint64>(base + 16);
+    quint64 poolSize = qFromLittleEndian<quint64>(base + 24);
+    const int slotSize = version >= 3 ? SLOT_SIZE : SLOT_SIZE_V2;
+    const quint64 lotsOff = HEADER_SIZE + quint64(count) * slotSize;
+    bool ok = std::memcmp(base, MAGIC, 4) == 0
+              && version >= 1 && version <= VERSION
+              && lotsOff + quint64(lotCount) * LOT_SIZE <= poolOff
+              && poolOff + poolSize <= fileSize;
+
+    if(ok) {
+        Decoder dec{base + poolOff, poolSize / 2, {}};
+        store.clear();
+        store.reserve(int(count));
+        for(quint32 i=0; i<count && ok; ++i) {
+            const uchar *slot = base + HEADER_SIZE + quint64(i) * slotSize;
+            quint32 f[6];
+            for(int k=0; k<6; ++k) f[k] = qFromLittleEndian<quint32>(slot + 16 + k * 4);
+
+            Medicine m;
+            m.id = qFromLittleEndian<qint32>(slot);
+            quint64 bits = qFromLittleEndian<quint64>(slot + 8);
+            std::memcpy(&m.price, &bits, sizeof(double));
+            if(!dec.valid(f[0], f[1]) || !dec.valid(f[4], f[5])) { ok = false; break; }
+            m.name = dec.plain(f[0], f[1]);
+            m.company = dec.shared(f[4], f[5]);
+
+            if(version == 1) {
+                // v1: stock in the slot and a free-text expiry in the pool
+                if(!dec.valid(f[2], f[3])) { ok = false; break; }
+                m.stock = qFromLittleEndian<qint32>(slot + 4);
+                m.setLegacyExpiry(dec.plain(f[2], f[3]), unreadable);
+            } else {
+                if(quint64(f[2]) + f[3] > lotCount) { ok = false; break; }
+                m.expiry = qFromLittleEndian<quint32>(slot + 4);
+                m.lots.resize(int(f[3]));
+                for(quint32 k=0; k<f[3]; ++k) {
+                    const uchar *lot = base + lotsOff + quint64(f[2] + k) * LOT_SIZE;
+                    m.lots[int(k)] = {qFromLittleEndian<quint32>(lot), qFromLittleEndian<qint32>(lot + 4)};
+                }
+            }
+            if(version >= 3) m.reorderLevel = qFromLittleEndian<qint32>(slot + 40);
+            if(!store.insert(m)) store.update(m);
+        }
+    }
+    file.unmap(base);
+    if(ok) Profiler::count(Profiler::RecordsLoaded, count);
+    return ok;
+}
+
+bool InventoryFile::write(const QString &path, const InventoryStore &store) {
+    Profiler::ScopedTimer timer(Profiler::SnapshotWrite);
+    const int count = store.size();
+    Pool pool;
+    QByteArray slots(count * SLOT_SIZE, Qt::Uninitialized);
+    QByteArray lots;
+    uchar *p = reinterpret_cast<uchar *>(slots.data());
+    quint32 lotCount = 0;
+
+    for(int i=0; i<count; ++i) {
+        const QString name = store.nameAt(i), &company = store.companyAt(i);
+        const QVector<Lot> recordLots = store.lotsAt(i);
+        const double price = store.priceAt(i);
+        quint64 bits;
+        std::memcpy(&bits, &price, sizeof(double));
+        qToLittleEndian<qint32>(store.idAt(i), p);
+        qToLittleEndian<quint32>(store.expiryAt(i), p + 4);
+        qToLittleEndian<quint64>(bits, p + 8);
+        qToLittleEndian<quint32>(pool.add(name), p + 16);
+        qToLittleEndian<quint32>(quint32(name.size()), p + 20);
+        qToLittleEndian<quint32>(lotCount, p + 24);
+        qToLittleEndian<quint32>(quint32(recordLots.size()), p + 28);
+        qToLittleEndian<quint32>(pool.add(company), p + 32);
+        qToLittleEndian<quint32>(quint32(company.size()), p + 36);
+        qToLittleEndian<qint32>(store.reorderLevelAt(i), p + 40);
+        for(const Lot &l : recordLots) {
+            char raw[LOT_SIZE];
+            qToLittleEndian<quint32>(l.expiry, raw);
+            qToLittleEndian<qint32>(l.qty, raw + 4);
+            lots.append(raw, LOT_SIZE);
+        }
+        lotCount += quint32(recordLots.size());
+        p += SLOT_SIZE;
+    }
+
+    uchar header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, 4);
+    qToLittleEndian<quint32>(VERSION, header + 4);
+    qToLittleEndian<quint32>(quint32(count), header + 8);
+    qToLittleEndian<quint32>(lotCount, header + 12);
+    qToLittleEndian<quint64>(quint64(HEADER_SIZE + slots.size() + lots.size()), header + 16);
+    qToLittleEndian<quint64>(quint64(pool.data.size()), header + 24);
+
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    file.write(reinterpret_cast<const char *>(header), HEADER_SIZE);
+    file.write(slots);
+    file.write(lots);
+    file.write(pool.data);
+    return file.commit();
+}
+
+bool InventoryFile::readLegacy(const QString &path, QVector<Medicine> &list, QStringList *unreadable) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&file);
+    quint32 count;
+    in >> count;
+    list.clear();
+    // A damaged count must not reserve gigabytes before the reads fail
+    if(in.status() != QDataStream::Ok || count > quint64(file.size() - 4) / LEGACY_RECORD_MIN) return false;
+    list.reserve(int(count));
+    for(quint32 i=0; i<count && in.status() == QDataStream::Ok; ++i) list.append(Medicine::readLegacy(in, unreadable));
+    return in.status() == QDataStream::Ok && list.size() == int(count);
+}
@@ -0,0 +1,32 @@
+#ifndef INVENTORYFILE_H
+#define INVENTORYFILE_H
+
+#include <QString>
+#include <QVector>
+#include "inventorystore.h"
+
+// --- INVENTORY FILE FORMAT ---
+// Fixed-layout snapshot read through QFile::map:
+//
+//   Header  "MSIV", version, record count, lot count, pool offset, pool size
+//   Slots   one fixed 44-byte slot per record: id, earliest expiry, price,
+//           name (offset, length), lots (first, count), company (offset,
+//           length), reorder level
+//   Lots    8 bytes each: packed expiry date, quantity
+//   Pool    UTF-16LE string data; identical strings are stored once
+//
+// Numeric fields are read straight out of the mapping and each distinct
+// company string is decoded once before the store interns it. Older versions (v2: no reorder level, v1: text expiry and
+// no lots) and the original QDataStream file are still readable so they
+// can be converted on start.
+//
+// Text expiries of v1 and the QDataStream file that cannot be read are
+// listed in 'unreadable' (see Medicine::setLegacyExpiry()).
+class InventoryFile {
+public:
+    static bool read(const QString &path, InventoryStore &store, QStringList *unreadable = nullptr);
+    static bool write(const QString &path, const InventoryStore &store);
+    static bool readLegacy(const QString &path, QVector<Medicine> &list, QStringList *unreadable = nullptr);
+};
+
+#endif // INVENTORYFILE_H
@@ -0,0 +1,267 @@
+#include "inventoryjournal.h"
+#include "inventoryfile.h"
+#include "fileutil.h"
+#include "profiler.h"
+#include <QDataStream>
+#include <QThread>
+#include <QtEndian>
+
+static const int RECORD_HEADER = 8;
+
+// A file with expiries that could not be read is copied to <file>.bak
+// before a checkpoint or compaction replaces it; an older copy is kept
+static void keepOriginal(const QString &path) {
+    QFile::copy(path, path + ".bak");
+}
+
+// --- WRITE-AHEAD JOURNAL ---
+InventoryJournal::InventoryJournal(const InventoryStore &store, const QString &snapshotPath, QObject *parent)
+    : QObject(parent), source(store), snapshotFile(snapshotPath),
+      journalFile(snapshotPath + ".journal"), sealedFile(snapshotPath + ".journal.sealed") {
+    // Group commit: every append inside this window shares one fsync
+    commitTimer.setSingleShot(true);
+    commitTimer.setInterval(20);
+    connect(&commitTimer, &QTimer::timeout, this, &InventoryJournal::flush);
+}
+
+InventoryJournal::~InventoryJournal() {
+    writePending();
+    if(compactor) {
+        compactor->wait();
+        delete compactor;
+    }
+}
+
+bool InventoryJournal::load(InventoryStore &store, const QString &legacyPath) {
+    Profiler::ScopedTimer timer(Profiler::StoreLoad);
+    unreadable.clear();
+    if(!InventoryFile::read(snapshotFile, store, &unreadable)) {
+        store.clear();
+        unreadable.clear();
+        // A snapshot that is there but unreadable (damaged, or from a newer
+        // version) must never be overwritten by what little was loaded
+        if(QFile::exists(snapshotFile)) return false;
+        // Likewise a damaged legacy file is left as it is, unconverted
+        if(!legacyPath.isEmpty() && QFile::exists(legacyPath) && !convertLegacy(legacyPath, store)) {
+            store.clear();
+            return false;
+        }
+    } else if(!unreadable.isEmpty()) {
+        keepOriginal(snapshotFile);
+    }
+
+    bool interrupted = QFile::exists(sealedFile);
+    int noted = unreadable.size();
+    if(interrupted) replay(sealedFile, store, &unreadable);
+    if(unreadable.size() > noted) keepOriginal(sealedFile);
+    noted = unreadable.size();
+    qint64 valid = replay(journalFile, store, &unreadable);
+    if(unreadable.size() > noted) keepOriginal(journalFile);
+
+    if(interrupted && InventoryFile::write(snapshotFile, store)) {
+        // A compaction did not finish last run; checkpoint now instead
+        QFile::remove(sealedFile);
+        QFile::remove(journalFile);
+    } else if(QFile::exists(journalFile)) {
+        // Drop a torn tail so new records follow the last good one
+        QFile::resize(journalFile, valid);
+    }
+    loaded = openJournal();
+    return loaded;
+}
+
+bool InventoryJournal::openJournal() {
+    journal.close();
+    journal.setFileName(journalFile);
+    return journal.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+qint64 InventoryJournal::replay(const QString &path, InventoryStore &store, QStringList *unreadable) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)) return 0;
+    const QByteArray data = file.readAll();
+    const char *p = data.constData();
+    qint64 pos = 0;
+
+    while(pos + RECORD_HEADER <= data.size()) {
+        quint32 len = qFromLittleEndian<quint32>(p + pos);
+        quint32 crc = qFromLittleEndian<quint32>(p + pos + 4);
+        if(len == 0 || pos + RECORD_HEADER + len > data.size()) break;
+        const char *body = p + pos + RECORD_HEADER;
+        if(FileUtil::crc32(body, len) != crc) break;
+
+        QByteArray payload = QByteArray::fromRawData(body + 1, len - 1);
+        QDataStream in(payload);
+        quint8 op = quint8(body[0]);
+        if(op == OpPut || op == OpPutLots || op == OpPutMedicine) {
+            Medicine m;
+            if(op == OpPut) m = Medicine::readLegacy(in, unreadable);
+            else if(op == OpPutLots) m = Medicine::readWithoutReorder(in);
+            else in >> m;
+            if(!store.update(m)) store.insert(m);
+        } else if(op == OpDelete) {
+            qint32 id;
+            in >> id;
+            store.remove(id);
+        }
+        pos += RECORD_HEADER + len;
+    }
+    return pos;
+}
+
+bool InventoryJournal::convertLegacy(const QString &legacyPath, InventoryStore &store) {
+    QVector<Medicine> list;
+    const int noted = unreadable.size();
+    if(!InventoryFile::readLegacy(legacyPath, list, &unreadable)) return false;
+    store.assign(list);
+    replay(legacyPath + ".journal.sealed", store, &unreadable);
+    replay(legacyPath + ".journal", store, &unreadable);
+    if(!InventoryFile::write(snapshotFile, store)) return false;
+    // With dates that could not be read, the old files stay as they are
+    // until someone has gone through the list
+    if(unreadable.size() > noted) return true;
+
+    QFile::remove(legacyPath + ".bak");
+    QFile::rename(legacyPath, legacyPath + ".bak");
+    QFile::remove(legacyPath + ".journal.sealed");
+    QFile::remove(legacyPath + ".journal");
+    return true;
+}
+
+void InventoryJournal::append(Op op, const QByteArray &payload) {
+    QByteArray body;
+    body.reserve(payload.size() + 1);
+    body.append(char(op));
+    body.append(payload);
+
+    char header[RECORD_HEADER];
+    qToLittleEndian<quint32>(quint32(body.size()), header);
+    qToLittleEndian<quint32>(FileUtil::crc32(body.constData(), body.size()), header + 4);
+    pending.append(header, RECORD_HEADER);
+    pending.append(body);
+    Profiler::count(Profiler::JournalRecords);
+
+    if(!commitTimer.isActive()) commitTimer.start();
+}
+
+void InventoryJournal::appendPut(const Medicine &m) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << m;
+    append(OpPutMedicine, payload);
+}
+
+void InventoryJournal::appendDelete(int id) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << qint32(id);
+    append(OpDelete, payload);
+}
+
+bool InventoryJournal::writePending() {
+    commitTimer.stop();
+    if(pending.isEmpty()) return true;
+    QString message;
+    if(journal.isOpen()) {
+        Profiler::ScopedTimer timer(Profiler::JournalWrite);
+        const qint64 start = journal.size();
+        if(journal.write(pending) == pending.size() && FileUtil::sync(journal)) {
+            pending.clear();
+            return true;
+        }
+        // Whatever part of the records reached the file is cut off, so the
+        // retry follows the last whole record
+        message = journal.errorString();
+        journal.close();
+        QFile::resize(journalFile, start);
+        openJournal();
+    } else {
+        message = "the journal is not open";
+    }
+    emit writeFailed("Cannot write " + journalFile + ": " + message);
+    return false;
+}
+
+bool InventoryJournal::flush() {
+    if(!writePending()) return false;
+    if(!compactor && journal.size() > compactThreshold) compactNow();
+    return true;
+}
+
+void InventoryJournal::compactNow() {
+    if(compactor || holds > 0 || !loaded) return;
+    if(!writePending()) return;
+    journal.close();
+
+    // Seal the current journal. A sealed file left by a failed compaction
+    // absorbs it, so no record is ever dropped before a snapshot holds it.
+    bool sealedOk = false;
+    if(QFile::exists(sealedFile)) {
+        QFile sealed(sealedFile), live(journalFile);
+        if(sealed.open(QIODevice::WriteOnly | QIODevice::Append) && live.open(QIODevice::ReadOnly)) {
+            const qint64 start = sealed.size();
+            const QByteArray records = live.readAll();
+            sealedOk = live.error() == QFileDevice::NoError && sealed.write(records) == records.size() && FileUtil::sync(sealed);
+            sealed.close();
+            live.close();
+            // A partial copy would hide whatever is appended after it
+            if(!sealedOk) QFile::resize(sealedFile, start);
+            else QFile::remove(journalFile);
+        }
+    } else {
+        sealedOk = QFile::rename(journalFile, sealedFile);
+    }
+    openJournal();
+    if(!sealedOk) {
+        // The live journal still holds every record; try again next flush
+        emit compactionFinished(false);
+        return;
+    }
+
+    const InventoryStore records = source.snapshot();
+    const QString snapshot = snapshotFile, sealed = sealedFile;
+    compactor = QThread::create([this, records, snapshot, sealed]() {
+        compactOk = InventoryFile::write(snapshot, records);
+        if(compactOk) QFile::remove(sealed);
+    });
+    connect(compactor, &QThread::finished, this, &InventoryJournal::finishCompaction);
+    compactor->start();
+}
+
+bool InventoryJournal::checkpoint() {
+    if(holds > 0 || !loaded) return false;
+    waitForCompaction();
+    writePending();
+    if(!InventoryFile::write(snapshotFile, source)) return false;
+    // Everything journaled so far, and anything that failed to reach the
+    // journal, is now in the snapshot
+    pending.clear();
+    journal.close();
+    QFile::remove(sealedFile);
+    QFile::remove(journalFile);
+    return openJournal();
+}
+
+void InventoryJournal::holdCompaction() {
+    waitForCompaction();
+    ++holds;
+}
+
+void InventoryJournal::releaseCompaction() {
+    if(holds == 0 || --holds > 0) return;
+    // Catch up on a compaction put off by the hold
+    if(journal.size() > compactThreshold) compactNow();
+}
+
+void InventoryJournal::waitForCompaction() {
+    if(!compactor) return;
+    compactor->wait();
+    finishCompaction();
+}
+
+void InventoryJournal::finishCompaction() {
+    if(!compactor) return;
+    compactor->deleteLater();
+    compactor = nullptr;
+    emit compactionFinished(compactOk);
+}
@@ -0,0 +1,104 @@
+#ifndef INVENTORYJOURNAL_H
+#define INVENTORYJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QByteArray>
+#include "inventorystore.h"
+
+class QThread;
+
+// --- WRITE-AHEAD JOURNAL ---
+// Persists the InventoryStore as a snapshot (see InventoryFile) plus an
+// append-only journal of put/delete records.
+//
+// Journal record: [quint32 length][quint32 crc32][quint8 op][payload]
+// where length covers op + payload. Appends are buffered and written with
+// a single fsync per group-commit window, so the cost of a sale does not
+// depend on catalogue size. Once the journal passes the compaction
+// threshold it is sealed (renamed to <journal>.sealed), a fresh journal is
+// started, and the snapshot is rewritten on a background thread.
+// Put and delete are idempotent, so replaying a sealed journal on top of a
+// snapshot that already contains it is harmless.
+class InventoryJournal : public QObject {
+    Q_OBJECT
+
+public:
+    InventoryJournal(const InventoryStore &store, const QString &snapshotPath, QObject *parent = nullptr);
+    ~InventoryJournal();
+
+    // Replays snapshot + sealed journal + live journal into 'store'. When
+    // no snapshot exists yet, a QDataStream snapshot at 'legacyPath' (and
+    // its journal) is converted once and kept as <legacyPath>.bak. Fails,
+    // touching nothing, if the snapshot exists but cannot be read, or if
+    // the legacy file cannot be read in full or converted; until a load
+    // succeeds the snapshot is never written.
+    bool load(InventoryStore &store, const QString &legacyPath = QString());
+    // Records from old formats whose free-text expiry the last load()
+    // could not read, as "id name: text". They were loaded undated; the
+    // files they came from are kept (medicines.dat and its journals as
+    // they are, anything else as a <file>.bak copy).
+    QStringList unreadableExpiries() const { return unreadable; }
+
+    void appendPut(const Medicine &m);
+    void appendDelete(int id);
+    // Writes and fsyncs the buffered records. If that fails they are kept
+    // (and the file cut back to the last whole record) for the next flush,
+    // writeFailed() is emitted and false returned.
+    bool flush();
+
+    void setCommitInterval(int msec) { commitTimer.setInterval(msec); }
+    void setCompactThreshold(qint64 bytes) { compactThreshold = bytes; }
+    bool isCompacting() const { return compactor != nullptr; }
+    void compactNow();
+    // Synchronously writes a snapshot of the store and empties the journal.
+    // Refused (false) while compaction is held.
+    bool checkpoint();
+    void waitForCompaction();
+    // While held, the snapshot and the sealed journal are left alone:
+    // compaction is put off and checkpoint() refuses, so another thread
+    // can copy a consistent file set. The live journal only grows, and a
+    // torn tail there is dropped on replay. Holds nest. Taking a hold
+    // waits for a running compaction; callers that must not block can
+    // check isCompacting() and retry on compactionFinished().
+    void holdCompaction();
+    void releaseCompaction();
+
+    QString snapshotPath() const { return snapshotFile; }
+    QString journalPath() const { return journalFile; }
+    QString sealedPath() const { return sealedFile; }
+
+signals:
+    void compactionFinished(bool ok);
+    void writeFailed(const QString &message);
+
+private:
+    // OpPut and OpPutLots carry older Medicine layouts and are only
+    // replayed; new puts are always OpPutMedicine.
+    enum Op : quint8 { OpPut = 1, OpDelete = 2, OpPutLots = 3, OpPutMedicine = 4 };
+
+    const InventoryStore &source;
+    QString snapshotFile;
+    QString journalFile;
+    QString sealedFile;
+
+    QFile journal;
+    QByteArray pending;
+    QTimer commitTimer;
+    qint64 compactThreshold = 4 * 1024 * 1024;
+    QThread *compactor = nullptr;
+    bool compactOk = false;
+    int holds = 0;
+    bool loaded = false;
+    QStringList unreadable;
+
+    void append(Op op, const QByteArray &payload);
+    bool writePending();
+    bool openJournal();
+    void finishCompaction();
+    static qint64 replay(const QString &path, InventoryStore &store, QStringList *unreadable = nullptr);
+    bool convertLegacy(const QString &legacyPath, InventoryStore &store);
+};
+
+#endif // INVENTORYJOURNAL_H
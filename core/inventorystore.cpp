@@ -0,0 +1,277 @@
+#include "inventorystore.h"
+#include <algorithm>
+
+// --- INVENTORY STORE ---
+template<typename T>
+static void swapRemove(QVector<T> &column, int slot) {
+    if(slot != column.size() - 1) column[slot] = column.last();
+    column.removeLast();
+}
+
+QVector<Lot> InventoryStore::lotsAt(int slot) const {
+    auto multi = multiLots.constFind(ids[slot]);
+    if(multi != multiLots.constEnd()) return multi.value();
+    if(stocks[slot] <= 0) return {};
+    return {Lot{expiries[slot], stocks[slot]}};
+}
+
+Medicine InventoryStore::at(int slot) const {
+    Medicine m;
+    m.id = ids[slot];
+    m.name = nameAt(slot);
+    m.price = prices[slot];
+    m.stock = stocks[slot];
+    m.expiry = expiries[slot];
+    m.company = companyAt(slot);
+    m.lots = lotsAt(slot);
+    m.reorderLevel = reorderLevels[slot];
+    return m;
+}
+
+std::optional<Medicine> InventoryStore::find(int id) const {
+    int slot = slotOf(id);
+    if(slot < 0) return std::nullopt;
+    return at(slot);
+}
+
+quint32 InventoryStore::internCompany(const QString &company) {
+    auto found = companyIndex.constFind(company);
+    if(found != companyIndex.constEnd()) return found.value();
+    quint32 index = quint32(companies.size());
+    companies.append(company);
+    companyIndex.insert(company, index);
+    return index;
+}
+
+void InventoryStore::setName(int slot, const QString &name) {
+    if(nameViewAt(slot) == name) return;
+    deadNameChars += nameLengths[slot];
+    nameOffsets[slot] = quint32(names.size());
+    nameLengths[slot] = quint32(name.size());
+    names.append(name);
+    if(deadNameChars > 4096 && deadNameChars > names.size() / 2) packNames();
+}
+
+void InventoryStore::packNames() {
+    QString packed;
+    packed.reserve(names.size() - int(deadNameChars));
+    for(int slot=0; slot<ids.size(); ++slot) {
+        quint32 offset = quint32(packed.size());
+        packed.append(nameViewAt(slot));
+        nameOffsets[slot] = offset;
+    }
+    names = packed;
+    deadNameChars = 0;
+}
+
+void InventoryStore::store(int slot, Medicine m) {
+    m.normalizeLots();
+    prices[slot] = m.price;
+    stocks[slot] = m.stock;
+    expiries[slot] = m.expiry;
+    reorderLevels[slot] = m.reorderLevel;
+    companyIds[slot] = internCompany(m.company);
+    setName(slot, m.name);
+    if(m.lots.size() > 1) multiLots.insert(m.id, m.lots);
+    else multiLots.remove(m.id);
+}
+
+void InventoryStore::indexLots(int slot) {
+    int id = ids[slot];
+    auto multi = multiLots.constFind(id);
+    if(multi == multiLots.constEnd()) {
+        if(stocks[slot] > 0 && expiries[slot]) expiryIndex.insert(expiryKey(expiries[slot], id), stocks[slot]);
+        return;
+    }
+    for(const Lot &l : multi.value()) if(l.expiry) expiryIndex.insert(expiryKey(l.expiry, id), l.qty);
+}
+
+void InventoryStore::unindexLots(int slot) {
+    int id = ids[slot];
+    auto multi = multiLots.constFind(id);
+    if(multi == multiLots.constEnd()) {
+        if(expiries[slot]) expiryIndex.remove(expiryKey(expiries[slot], id));
+        return;
+    }
+    for(const Lot &l : multi.value()) if(l.expiry) expiryIndex.remove(expiryKey(l.expiry, id));
+}
+
+void InventoryStore::trackStock(int slot) {
+    if(needsReorderAt(slot)) lowStock.insert(ids[slot]);
+    else lowStock.remove(ids[slot]);
+}
+
+bool InventoryStore::insert(const Medicine &m) {
+    if(slots.contains(m.id)) return false;
+    int slot = ids.size();
+    slots.insert(m.id, slot);
+    ids.append(m.id);
+    prices.append(0);
+    stocks.append(0);
+    expiries.append(0);
+    reorderLevels.append(0);
+    companyIds.append(0);
+    nameOffsets.append(quint32(names.size()));
+    nameLengths.append(0);
+    store(slot, m);
+    indexLots(slot);
+    trackStock(slot);
+    return true;
+}
+
+bool InventoryStore::update(const Medicine &m) {
+    int slot = slotOf(m.id);
+    if(slot < 0) return false;
+    unindexLots(slot);
+    store(slot, m);
+    indexLots(slot);
+    trackStock(slot);
+    return true;
+}
+
+int InventoryStore::takeStock(int id, int qty) {
+    int slot = slotOf(id);
+    if(slot < 0 || qty <= 0) return 0;
+    unindexLots(slot);
+    // Only the stock fields take part in FEFO, so the name is never copied
+    Medicine m;
+    m.id = id;
+    m.stock = stocks[slot];
+    m.expiry = expiries[slot];
+    m.lots = lotsAt(slot);
+    int taken = m.takeFefo(qty);
+    stocks[slot] = m.stock;
+    expiries[slot] = m.expiry;
+    if(m.lots.size() > 1) multiLots.insert(id, m.lots);
+    else multiLots.remove(id);
+    indexLots(slot);
+    trackStock(slot);
+    return taken;
+}
+
+QVector<InventoryStore::ExpiringLot> InventoryStore::expiringBy(PackedDate limit) const {
+    QVector<ExpiringLot> result;
+    const auto end = expiryIndex.upperBound(expiryKey(limit, -1));
+    for(auto it = expiryIndex.constBegin(); it != end; ++it) {
+        result.append({int(quint32(it.key())), PackedDate(it.key() >> 32), it.value()});
+    }
+    return result;
+}
+
+QMap<QString, QVector<int>> InventoryStore::reorderByCompany() const {
+    QMap<QString, QVector<int>> groups;
+    for(int id : lowStock) groups[companyAt(slotOf(id))].append(id);
+    for(auto &group : groups) {
+        std::sort(group.begin(), group.end(), [this](int a, int b) {
+            int c = nameViewAt(slotOf(a)).compare(nameViewAt(slotOf(b)), Qt::CaseInsensitive);
+            return c != 0 ? c < 0 : a < b;
+        });
+    }
+    return groups;
+}
+
+int InventoryStore::remove(int id) {
+    auto found = slots.find(id);
+    if(found == slots.end()) return -1;
+    int slot = found.value();
+    int last = ids.size() - 1;
+    slots.erase(found);
+    unindexLots(slot);
+    lowStock.remove(id);
+    multiLots.remove(id);
+    deadNameChars += nameLengths[slot];
+
+    swapRemove(ids, slot);
+    swapRemove(prices, slot);
+    swapRemove(stocks, slot);
+    swapRemove(expiries, slot);
+    swapRemove(reorderLevels, slot);
+    swapRemove(companyIds, slot);
+    swapRemove(nameOffsets, slot);
+    swapRemove(nameLengths, slot);
+    if(ids.isEmpty()) {
+        names.clear();
+        deadNameChars = 0;
+    }
+    if(slot == last) return -1;
+    slots[ids[slot]] = slot;
+    return slot;
+}
+
+void InventoryStore::assign(const QVector<Medicine> &list) {
+    clear();
+    reserve(list.size());
+    // Later duplicates overwrite earlier ones, as the last write wins on disk
+    for(const auto &m : list) {
+        if(!insert(m)) update(m);
+    }
+}
+
+void InventoryStore::reserve(int n) {
+    ids.reserve(n);
+    prices.reserve(n);
+    stocks.reserve(n);
+    expiries.reserve(n);
+    reorderLevels.reserve(n);
+    companyIds.reserve(n);
+    nameOffsets.reserve(n);
+    nameLengths.reserve(n);
+    slots.reserve(n);
+}
+
+void InventoryStore::clear() {
+    ids.clear();
+    prices.clear();
+    stocks.clear();
+    expiries.clear();
+    reorderLevels.clear();
+    companyIds.clear();
+    nameOffsets.clear();
+    nameLengths.clear();
+    names.clear();
+    deadNameChars = 0;
+    companies.clear();
+    companyIndex.clear();
+    multiLots.clear();
+    slots.clear();
+    expiryIndex.clear();
+    lowStock.clear();
+}
+
+InventoryStore InventoryStore::snapshot() const {
+    InventoryStore s;
+    s.ids = ids;
+    s.prices = prices;
+    s.stocks = stocks;
+    s.expiries = expiries;
+    s.reorderLevels = reorderLevels;
+    s.companyIds = companyIds;
+    s.nameOffsets = nameOffsets;
+    s.nameLengths = nameLengths;
+    s.names = names;
+    s.deadNameChars = deadNameChars;
+    s.companies = companies;
+    s.multiLots = multiLots;
+    return s;
+}
+
+InventoryStore::MemoryUsage InventoryStore::memoryUsage() const {
+    // Array header of an implicitly shared Qt container, and the node
+    // overhead of a std::map entry behind QMap
+    const qint64 header = 16, mapNode = 32;
+    MemoryUsage usage;
+    usage.columns = ids.capacity() * qint64(sizeof(qint32)) + prices.capacity() * qint64(sizeof(double))
+                    + stocks.capacity() * qint64(sizeof(qint32)) + expiries.capacity() * qint64(sizeof(PackedDate))
+                    + reorderLevels.capacity() * qint64(sizeof(qint32)) + companyIds.capacity() * qint64(sizeof(quint32))
+                    + nameOffsets.capacity() * qint64(sizeof(quint32)) + nameLengths.capacity() * qint64(sizeof(quint32));
+    usage.names = header + names.capacity() * qint64(sizeof(QChar));
+    usage.companies = companies.capacity() * qint64(sizeof(QString))
+                      + companyIndex.capacity() * qint64(sizeof(QString) + sizeof(quint32) + 1);
+    for(const QString &c : companies) usage.companies += header + c.capacity() * qint64(sizeof(QChar));
+    usage.lots = multiLots.capacity() * qint64(sizeof(int) + sizeof(QVector<Lot>) + 1);
+    for(const auto &lots : multiLots) usage.lots += header + lots.capacity() * qint64(sizeof(Lot));
+    usage.indexes = slots.capacity() * qint64(2 * sizeof(int) + 1)
+                    + expiryIndex.size() * (mapNode + qint64(sizeof(quint64) + sizeof(int)))
+                    + lowStock.capacity() * qint64(sizeof(int) + 1);
+    return usage;
+}
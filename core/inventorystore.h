@@ -0,0 +1,155 @@
+#ifndef INVENTORYSTORE_H
+#define INVENTORYSTORE_H
+
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringView>
+#include <optional>
+#include "medicine.h"
+
+// --- INVENTORY STORE ---
+// Owns the medicine records, laid out column by column: the hot numeric
+// fields (id, price, stock, expiry, reorder level) each live in their own
+// dense array, so scans and valuations touch only the bytes they need.
+// Names are packed back to back in one UTF-16 arena, company names are
+// interned into a dictionary and referenced by index, and lots are stored
+// only for the records that hold more than one (a single lot is fully
+// described by stock and expiry). Medicine stays the exchange type: at()
+// and find() assemble one on demand.
+//
+// The medicine id is the stable handle: slots are dense and may change
+// when a record is deleted (the last record is swapped into the hole),
+// so callers should keep ids and resolve them with slotOf().
+//
+// An ordered expiry index of every dated lot, keyed by (expiry, id), is
+// kept in step with each mutation, so near-expiry queries cost
+// O(log n + matches) rather than a catalogue scan. Likewise the set of
+// ids below their reorder level is updated as stock moves, so low-stock
+// checks and the reorder report never walk the whole catalogue.
+//
+// Every member is implicitly shared, so a copy is cheap to take and is a
+// consistent snapshot for another thread. The cost moves to the first
+// write made to the original while the copy is alive: each container
+// that write touches is detached, i.e. copied whole. Background readers
+// therefore take snapshot(), which leaves the hash and map indexes out.
+class InventoryStore {
+public:
+    struct ExpiringLot {
+        int id;
+        PackedDate expiry;
+        int qty;
+    };
+
+    // Approximate heap bytes held by each part of the store
+    struct MemoryUsage {
+        qint64 columns = 0;
+        qint64 names = 0;
+        qint64 companies = 0;
+        qint64 lots = 0;
+        qint64 indexes = 0;
+
+        qint64 total() const { return columns + names + companies + lots + indexes; }
+    };
+
+    int size() const { return ids.size(); }
+    bool isEmpty() const { return ids.isEmpty(); }
+
+    int idAt(int slot) const { return ids[slot]; }
+    double priceAt(int slot) const { return prices[slot]; }
+    int stockAt(int slot) const { return stocks[slot]; }
+    PackedDate expiryAt(int slot) const { return expiries[slot]; }
+    int reorderLevelAt(int slot) const { return reorderLevels[slot]; }
+    bool needsReorderAt(int slot) const { return stocks[slot] < reorderLevels[slot]; }
+    QStringView nameViewAt(int slot) const { return QStringView(names).mid(nameOffsets[slot], nameLengths[slot]); }
+    QString nameAt(int slot) const { return names.mid(int(nameOffsets[slot]), int(nameLengths[slot])); }
+    const QString &companyAt(int slot) const { return companies[companyIds[slot]]; }
+    QVector<Lot> lotsAt(int slot) const;
+    Medicine at(int slot) const;
+
+    int slotOf(int id) const { return slots.value(id, -1); }
+    bool contains(int id) const { return slots.contains(id); }
+    std::optional<Medicine> find(int id) const;
+
+    // Records are stored with normalized lots (see Medicine)
+    bool insert(const Medicine &m);
+    bool update(const Medicine &m);
+    // Deducts first-expiry-first-out; returns the quantity actually taken
+    int takeStock(int id, int qty);
+    // Returns the slot that now holds the previously-last record, or -1
+    // when the removed record was the last one (or did not exist).
+    int remove(int id);
+
+    void assign(const QVector<Medicine> &list);
+    void reserve(int n);
+    void clear();
+
+    // The records without the id, expiry and low-stock indexes, for
+    // readers on another thread that only walk slots (idAt(), at(),
+    // the columns, lotsAt()). A sale made while it is alive copies the
+    // flat columns it touches (the bench reports this as
+    // sale_during_snapshot) instead of rebuilding hash and map nodes.
+    // slotOf(), find(), expiringBy() and the low-stock queries see
+    // nothing on it.
+    InventoryStore snapshot() const;
+
+    // Dated lots expiring on or before 'limit', soonest first
+    QVector<ExpiringLot> expiringBy(PackedDate limit) const;
+
+    bool isLowStock(int id) const { return lowStock.contains(id); }
+    int lowStockCount() const { return lowStock.size(); }
+    const QSet<int> &lowStockIds() const { return lowStock; }
+    // Low-stock ids grouped by company, each group sorted by name
+    QMap<QString, QVector<int>> reorderByCompany() const;
+
+    int companyCount() const { return companies.size(); }
+    const QString &companyName(int index) const { return companies[index]; }
+
+    // Raw columns for bulk kernels; valid until the store is next modified
+    const double *priceColumn() const { return prices.constData(); }
+    const qint32 *stockColumn() const { return stocks.constData(); }
+    const PackedDate *expiryColumn() const { return expiries.constData(); }
+    const quint32 *companyColumn() const { return companyIds.constData(); }
+    // Lots of the records that hold more than one, keyed by id; every other
+    // record is a single lot of stockAt() expiring on expiryAt()
+    const QHash<int, QVector<Lot>> &multiLotRecords() const { return multiLots; }
+    MemoryUsage memoryUsage() const;
+
+private:
+    // One entry per slot
+    QVector<qint32> ids;
+    QVector<double> prices;
+    QVector<qint32> stocks;
+    QVector<PackedDate> expiries;
+    QVector<qint32> reorderLevels;
+    QVector<quint32> companyIds;
+    QVector<quint32> nameOffsets;
+    QVector<quint32> nameLengths;
+
+    // Name arena; replaced and removed names stay behind as dead space
+    // until it outgrows the live text and the arena is repacked.
+    QString names;
+    qint64 deadNameChars = 0;
+
+    QVector<QString> companies;
+    QHash<QString, quint32> companyIndex;
+
+    // Lots of the records that hold two or more
+    QHash<int, QVector<Lot>> multiLots;
+
+    QHash<int, int> slots;
+    QMap<quint64, int> expiryIndex;
+    QSet<int> lowStock;
+
+    static quint64 expiryKey(PackedDate expiry, int id) { return (quint64(expiry) << 32) | quint32(id); }
+    quint32 internCompany(const QString &company);
+    void setName(int slot, const QString &name);
+    void packNames();
+    void store(int slot, Medicine m);
+    void indexLots(int slot);
+    void unindexLots(int slot);
+    void trackStock(int slot);
+};
+
+#endif // INVENTORYSTORE_H
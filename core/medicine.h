@@ -0,0 +1,183 @@
+#ifndef MEDICINE_H
+#define MEDICINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDate>
+#include <QDataStream>
+#include <algorithm>
+#include <climits>
+
+// --- MONEY ---
+// Cart, sale and ledger amounts are integer paisa, so totals are exact
+inline qint64 toPaisa(double rupees) { return qRound64(rupees * 100); }
+
+inline QString formatRupees(qint64 paisa) {
+    qint64 whole = qAbs(paisa) / 100, fraction = qAbs(paisa) % 100;
+    return QString(paisa < 0 ? "-" : "") + QString::number(whole) + "." + QString::number(fraction).rightJustified(2, '0');
+}
+
+// --- DATES ---
+// Calendar date packed as yyyymmdd, so integer order is date order.
+// 0 means "no expiry recorded".
+typedef quint32 PackedDate;
+
+inline PackedDate packDate(const QDate &d) {
+    return d.isValid() ? PackedDate(d.year() * 10000 + d.month() * 100 + d.day()) : 0;
+}
+
+inline QDate unpackDate(PackedDate p) {
+    return p ? QDate(int(p / 10000), int(p / 100 % 100), int(p % 100)) : QDate();
+}
+
+inline QString formatExpiry(PackedDate p) {
+    return p ? unpackDate(p).toString("yyyy-MM-dd") : QString();
+}
+
+// Accepts full dates and month-only dates (taken as the month's last day)
+inline PackedDate parseExpiry(const QString &text) {
+    const QString t = text.trimmed();
+    if(t.isEmpty()) return 0;
+    for(const char *fmt : {"yyyy-MM-dd", "dd/MM/yyyy", "dd-MM-yyyy", "yyyy/MM/dd"}) {
+        QDate d = QDate::fromString(t, QString::fromLatin1(fmt));
+        if(d.isValid()) return packDate(d);
+    }
+    for(const char *fmt : {"yyyy-MM", "MM/yyyy", "MM-yyyy", "yyyy/MM"}) {
+        QDate d = QDate::fromString(t, QString::fromLatin1(fmt));
+        if(d.isValid()) return packDate(QDate(d.year(), d.month(), d.daysInMonth()));
+    }
+    return 0;
+}
+
+// --- DATA STRUCTURES ---
+struct Lot {
+    PackedDate expiry;
+    int qty;
+
+    // Lots without a date are used last
+    quint32 fefoKey() const { return expiry ? expiry : UINT_MAX; }
+
+    friend QDataStream &operator<<(QDataStream &out, const Lot &l) { return out << l.expiry << qint32(l.qty); }
+    friend QDataStream &operator>>(QDataStream &in, Lot &l) {
+        qint32 qty;
+        in >> l.expiry >> qty;
+        l.qty = qty;
+        return in;
+    }
+};
+
+// 'stock' is the sum of the lots and 'expiry' the earliest lot's date.
+// A record built with stock but no lots (form input, CSV, old files) is
+// treated as a single lot expiring on 'expiry'; normalizeLots() restores
+// the invariant. Stock below reorderLevel marks the item for reordering.
+struct Medicine {
+    static const int DEFAULT_REORDER_LEVEL = 10;
+
+    int id = 0;
+    QString name;
+    double price = 0;
+    int stock = 0;
+    PackedDate expiry = 0;
+    QString company;
+    QVector<Lot> lots;
+    int reorderLevel = DEFAULT_REORDER_LEVEL;
+
+    bool needsReorder() const { return stock < reorderLevel; }
+    // Suggested order brings stock back up to twice the reorder level
+    int reorderQuantity() const { return needsReorder() ? 2 * reorderLevel - stock : 0; }
+
+    void normalizeLots() {
+        if(lots.isEmpty() && stock > 0) lots.append({expiry, stock});
+        std::sort(lots.begin(), lots.end(), [](const Lot &a, const Lot &b) { return a.fefoKey() < b.fefoKey(); });
+        QVector<Lot> merged;
+        for(const Lot &l : lots) {
+            if(l.qty <= 0) continue;
+            if(!merged.isEmpty() && merged.last().expiry == l.expiry) merged.last().qty += l.qty;
+            else merged.append(l);
+        }
+        lots = merged;
+        stock = 0;
+        for(const Lot &l : lots) stock += l.qty;
+        if(!lots.isEmpty()) expiry = lots.first().expiry;
+    }
+
+    // First-expiry-first-out deduction; returns how much was taken
+    int takeFefo(int qty) {
+        int taken = 0;
+        for(Lot &l : lots) {
+            if(taken == qty) break;
+            int n = qMin(l.qty, qty - taken);
+            l.qty -= n;
+            taken += n;
+        }
+        normalizeLots();
+        return taken;
+    }
+
+    QString lotSummary() const { return summarizeLots(lots); }
+
+    static QString summarizeLots(const QVector<Lot> &lots) {
+        QStringList parts;
+        for(const Lot &l : lots) parts << (l.expiry ? formatExpiry(l.expiry) : QString("no date")) + " x" + QString::number(l.qty);
+        return parts.join(", ");
+    }
+
+    friend QDataStream &operator<<(QDataStream &out, const Medicine &m) {
+        return out << m.id << m.name << m.price << m.stock << m.expiry << m.company << m.lots << qint32(m.reorderLevel);
+    }
+    friend QDataStream &operator>>(QDataStream &in, Medicine &m) {
+        qint32 level;
+        in >> m.id >> m.name >> m.price >> m.stock >> m.expiry >> m.company >> m.lots >> level;
+        m.reorderLevel = level;
+        return in;
+    }
+
+    // Lots layout written before reorder levels existed
+    static Medicine readWithoutReorder(QDataStream &in) {
+        Medicine m;
+        in >> m.id >> m.name >> m.price >> m.stock >> m.expiry >> m.company >> m.lots;
+        return m;
+    }
+
+    // Original layout with free-text expiry, as in medicines.dat and old journals
+    static Medicine readLegacy(QDataStream &in, QStringList *unreadable = nullptr) {
+        Medicine m;
+        QString expiryText;
+        in >> m.id >> m.name >> m.price >> m.stock >> expiryText >> m.company;
+        m.setLegacyExpiry(expiryText, unreadable);
+        m.normalizeLots();
+        return m;
+    }
+
+    // Free-text expiry of the original layouts. Text parseExpiry() cannot
+    // read leaves the record undated and is noted in 'unreadable' as
+    // "id name: text", so it can be shown before the source is retired.
+    void setLegacyExpiry(const QString &text, QStringList *unreadable) {
+        expiry = parseExpiry(text);
+        if(!expiry && unreadable && !text.trimmed().isEmpty()) unreadable->append(QString("%1 %2: %3").arg(id).arg(name, text.trimmed()));
+    }
+};
+
+// Price is fixed when the item goes into the cart
+struct CartItem {
+    int medId;
+    QString name;
+    qint64 unitPaisa;
+    int qty;
+
+    qint64 lineTotal() const { return unitPaisa * qty; }
+
+    friend QDataStream &operator<<(QDataStream &out, const CartItem &c) {
+        return out << qint32(c.medId) << c.name << c.unitPaisa << qint32(c.qty);
+    }
+    friend QDataStream &operator>>(QDataStream &in, CartItem &c) {
+        qint32 id, qty;
+        in >> id >> c.name >> c.unitPaisa >> qty;
+        c.medId = id;
+        c.qty = qty;
+        return in;
+    }
+};
+
+#endif // MEDICINE_H
@@ -0,0 +1,251 @@
+#include "profiler.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QCoreApplication>
+#include <QtAlgorithms>
+#include <vector>
+
+namespace Profiler {
+
+QBasicAtomicInt active = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+namespace {
+
+const int BUCKETS = 256;
+const int TRACE_CAPACITY = 1 << 16;
+
+const char *const PROBE_NAMES[ProbeCount] = {
+    "store.load", "snapshot.read", "snapshot.write", "journal.write", "store.flush", "store.import",
+    "search.rebuild", "search.query", "cart.add", "checkout", "server.commit", "ui.table_refresh", "ui.receipt",
+    "analytics.block", "receipt.print", "receipt.export"
+};
+const char *const COUNTER_NAMES[CounterCount] = {
+    "records_loaded", "journal_records", "search_hits", "sale_lines", "reservations_refused"
+};
+
+struct TraceEvent {
+    int probe;
+    qint64 start;
+    qint64 duration;
+};
+
+// Written only by its own thread; other threads just read. Kept for the
+// life of the process so spans of finished threads still reach the trace.
+// The data belongs to the reset generation in 'generation'.
+struct ThreadData {
+    int tid = 0;
+    QString name;
+    QAtomicInt generation;
+    QAtomicInteger<quint64> buckets[ProbeCount][BUCKETS];
+    QAtomicInteger<qint64> totalNs[ProbeCount];
+    QAtomicInteger<qint64> maxNs[ProbeCount];
+    QAtomicInteger<qint64> counts[CounterCount];
+    QAtomicPointer<TraceEvent> trace;
+    QAtomicInt traceSize;
+};
+
+QBasicAtomicInt tracing = Q_BASIC_ATOMIC_INITIALIZER(0);
+QBasicAtomicInt generation = Q_BASIC_ATOMIC_INITIALIZER(0);
+QBasicAtomicInteger<qint64> traceDropped = Q_BASIC_ATOMIC_INITIALIZER(0);
+QMutex registryLock;
+std::vector<ThreadData *> registry;
+thread_local ThreadData *current = nullptr;
+
+// Clears the calling thread's data left from before the last reset()
+void renew(ThreadData *t, int now) {
+    for(int p=0; p<ProbeCount; ++p) {
+        for(int b=0; b<BUCKETS; ++b) t->buckets[p][b].storeRelaxed(0);
+        t->totalNs[p].storeRelaxed(0);
+        t->maxNs[p].storeRelaxed(0);
+    }
+    for(int c=0; c<CounterCount; ++c) t->counts[c].storeRelaxed(0);
+    t->traceSize.storeRelaxed(0);
+    t->generation.storeRelease(now);
+}
+
+ThreadData *local() {
+    if(current) {
+        const int now = generation.loadRelaxed();
+        if(current->generation.loadRelaxed() != now) renew(current, now);
+        return current;
+    }
+    current = new ThreadData;
+    current->generation.storeRelaxed(generation.loadRelaxed());
+    QThread *thread = QThread::currentThread();
+    current->name = thread->objectName();
+    if(current->name.isEmpty()) {
+        bool main = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+        current->name = main ? QString("main") : QString("thread");
+    }
+    QMutexLocker locker(&registryLock);
+    current->tid = int(registry.size()) + 1;
+    registry.push_back(current);
+    return current;
+}
+
+// Threads with data from the current generation
+std::vector<ThreadData *> threads() {
+    const int now = generation.loadAcquire();
+    QMutexLocker locker(&registryLock);
+    std::vector<ThreadData *> live;
+    for(ThreadData *t : registry) {
+        if(t->generation.loadAcquire() == now) live.push_back(t);
+    }
+    return live;
+}
+
+// 0..3 exact, then four buckets per power of two
+int bucketOf(qint64 ns) {
+    if(ns < 4) return ns < 0 ? 0 : int(ns);
+    int msb = 63 - int(qCountLeadingZeroBits(quint64(ns)));
+    int sub = int((quint64(ns) >> (msb - 2)) & 3);
+    return qMin(BUCKETS - 1, (msb - 1) * 4 + sub);
+}
+
+// Midpoint of the bucket's range
+qint64 bucketValue(int index) {
+    if(index < 4) return index;
+    int msb = index / 4 + 1, sub = index % 4;
+    qint64 low = qint64(4 + sub) << (msb - 2);
+    return low + (qint64(1) << (msb - 2)) / 2;
+}
+
+qint64 percentileOf(const quint64 *merged, quint64 total, double p) {
+    quint64 rank = quint64(p * double(total - 1)) + 1, seen = 0;
+    for(int b=0; b<BUCKETS; ++b) {
+        seen += merged[b];
+        if(seen >= rank) return bucketValue(b);
+    }
+    return 0;
+}
+
+}
+
+void setEnabled(bool on) {
+    active.storeRelaxed(on ? 1 : 0);
+    if(!on) tracing.storeRelaxed(0);
+}
+
+void setTracing(bool on) {
+    tracing.storeRelaxed(on ? 1 : 0);
+    if(on) active.storeRelaxed(1);
+}
+
+bool isTracing() { return tracing.loadRelaxed() != 0; }
+
+void reset() {
+    generation.fetchAndAddRelease(1);
+    traceDropped.storeRelaxed(0);
+}
+
+void record(Probe probe, qint64 startNs, qint64 durationNs) {
+    ThreadData *t = local();
+    // Single writer per thread, so a load and a store replace an atomic add
+    auto &bucket = t->buckets[probe][bucketOf(durationNs)];
+    bucket.storeRelaxed(bucket.loadRelaxed() + 1);
+    t->totalNs[probe].storeRelaxed(t->totalNs[probe].loadRelaxed() + durationNs);
+    if(durationNs > t->maxNs[probe].loadRelaxed()) t->maxNs[probe].storeRelaxed(durationNs);
+
+    if(!isTracing()) return;
+    TraceEvent *events = t->trace.loadRelaxed();
+    if(!events) {
+        events = new TraceEvent[TRACE_CAPACITY];
+        t->trace.storeRelease(events);
+    }
+    int n = t->traceSize.loadRelaxed();
+    if(n >= TRACE_CAPACITY) { traceDropped.fetchAndAddRelaxed(1); return; }
+    events[n] = {int(probe), startNs, durationNs};
+    t->traceSize.storeRelease(n + 1);
+}
+
+void addCount(Counter counter, qint64 n) {
+    ThreadData *t = local();
+    t->counts[counter].storeRelaxed(t->counts[counter].loadRelaxed() + n);
+}
+
+const char *probeName(Probe probe) { return PROBE_NAMES[probe]; }
+const char *counterName(Counter counter) { return COUNTER_NAMES[counter]; }
+
+QVector<ProbeStats> stats() {
+    const std::vector<ThreadData *> all = threads();
+    QVector<ProbeStats> result;
+    for(int p=0; p<ProbeCount; ++p) {
+        quint64 merged[BUCKETS] = {};
+        ProbeStats s;
+        s.name = QString::fromLatin1(PROBE_NAMES[p]);
+        for(ThreadData *t : all) {
+            for(int b=0; b<BUCKETS; ++b) merged[b] += t->buckets[p][b].loadRelaxed();
+            s.totalNs += t->totalNs[p].loadRelaxed();
+            s.maxNs = qMax(s.maxNs, t->maxNs[p].loadRelaxed());
+        }
+        quint64 total = 0;
+        for(int b=0; b<BUCKETS; ++b) total += merged[b];
+        if(total == 0) continue;
+        s.count = qint64(total);
+        s.p50Ns = percentileOf(merged, total, 0.50);
+        s.p90Ns = percentileOf(merged, total, 0.90);
+        s.p99Ns = qMin(s.maxNs, percentileOf(merged, total, 0.99));
+        result.append(s);
+    }
+    return result;
+}
+
+QMap<QString, qint64> counters() {
+    QMap<QString, qint64> result;
+    const std::vector<ThreadData *> all = threads();
+    for(int c=0; c<CounterCount; ++c) {
+        qint64 sum = 0;
+        for(ThreadData *t : all) sum += t->counts[c].loadRelaxed();
+        if(sum) result.insert(QString::fromLatin1(COUNTER_NAMES[c]), sum);
+    }
+    return result;
+}
+
+QString report() {
+    QString text = QString("%1 %2 %3 %4 %5 %6 %7\n").arg("probe", -18).arg("count", 9).arg("mean us", 11)
+                       .arg("p50 us", 11).arg("p90 us", 11).arg("p99 us", 11).arg("max us", 11);
+    for(const ProbeStats &s : stats()) {
+        text += QString("%1 %2 %3 %4 %5 %6 %7\n").arg(s.name, -18).arg(s.count, 9)
+                    .arg(s.totalNs / 1000.0 / s.count, 11, 'f', 1).arg(s.p50Ns / 1000.0, 11, 'f', 1)
+                    .arg(s.p90Ns / 1000.0, 11, 'f', 1).arg(s.p99Ns / 1000.0, 11, 'f', 1).arg(s.maxNs / 1000.0, 11, 'f', 1);
+    }
+    const QMap<QString, qint64> totals = counters();
+    for(auto it = totals.cbegin(); it != totals.cend(); ++it) text += QString("%1 %2\n").arg(it.key(), -18).arg(it.value(), 9);
+    if(qint64 dropped = traceDropped.loadRelaxed()) text += QString("%1 %2\n").arg("trace_dropped", -18).arg(dropped, 9);
+    return text;
+}
+
+bool writeTrace(const QString &path) {
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) return false;
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&]() { if(!first) json += ",\n"; first = false; };
+    for(ThreadData *t : threads()) {
+        separate();
+        json += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                    .arg(pid).arg(t->tid).arg(QString(t->name).replace('\\', "\\\\").replace('"', "\\\"")).toUtf8();
+        const TraceEvent *events = t->trace.loadAcquire();
+        const int n = events ? t->traceSize.loadAcquire() : 0;
+        for(int i=0; i<n; ++i) {
+            const TraceEvent &e = events[i];
+            separate();
+            json += "{\"name\":\"";
+            json += PROBE_NAMES[e.probe];
+            json += "\",\"cat\":\"medstore\",\"ph\":\"X\",\"pid\":" + QByteArray::number(pid) + ",\"tid\":" + QByteArray::number(t->tid)
+                    + ",\"ts\":" + QByteArray::number(e.start / 1000.0, 'f', 3) + ",\"dur\":" + QByteArray::number(e.duration / 1000.0, 'f', 3) + "}";
+        }
+        if(json.size() > (1 << 20)) {
+            file.write(json);
+            json.clear();
+        }
+    }
+    json += "]}\n";
+    file.write(json);
+    return file.commit();
+}
+
+}
@@ -0,0 +1,104 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QAtomicInt>
+#include <chrono>
+
+// --- PROFILER ---
+// Scoped timers and counters on the load, save, search, cart and checkout
+// paths. Each thread records into its own latency histograms (log-linear
+// buckets, four per power of two), written only by that thread with
+// relaxed atomics, so recording never takes a lock and never contends.
+// Reports merge every thread's histograms on demand. reset() only starts
+// a new generation: each thread clears its own data the next time it
+// records, and until then reports leave that thread out.
+//
+// Disabled by default: a timer then costs one relaxed load and a branch.
+// With tracing on, each thread also keeps its spans in a fixed buffer
+// that writeTrace() exports as Chrome trace-event JSON (chrome://tracing,
+// Perfetto). A full buffer drops further spans rather than wrapping.
+namespace Profiler {
+
+enum Probe {
+    StoreLoad,
+    SnapshotRead,
+    SnapshotWrite,
+    JournalWrite,
+    StoreFlush,
+    StoreImport,
+    SearchRebuild,
+    SearchQuery,
+    CartAdd,
+    Checkout,
+    ServerCommit,
+    TableRefresh,
+    ReceiptBuild,
+    AnalyticsBlock,
+    ReceiptPrint,
+    ReceiptExport,
+    ProbeCount
+};
+
+enum Counter {
+    RecordsLoaded,
+    JournalRecords,
+    SearchHits,
+    SaleLines,
+    ReservationsRefused,
+    CounterCount
+};
+
+struct ProbeStats {
+    QString name;
+    qint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 p50Ns = 0;
+    qint64 p90Ns = 0;
+    qint64 p99Ns = 0;
+    qint64 maxNs = 0;
+};
+
+extern QBasicAtomicInt active;
+
+inline bool isEnabled() { return active.loadRelaxed() != 0; }
+inline qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void setEnabled(bool on);
+// Tracing implies enabled
+void setTracing(bool on);
+bool isTracing();
+void reset();
+
+void record(Probe probe, qint64 startNs, qint64 durationNs);
+void addCount(Counter counter, qint64 n);
+inline void count(Counter counter, qint64 n = 1) { if(isEnabled()) addCount(counter, n); }
+
+const char *probeName(Probe probe);
+const char *counterName(Counter counter);
+
+// Probes that recorded at least once, merged across threads
+QVector<ProbeStats> stats();
+QMap<QString, qint64> counters();
+// Fixed-width table of stats() and counters() for logs and the CLI
+QString report();
+bool writeTrace(const QString &path);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Probe probe) : probe(probe), start(isEnabled() ? nowNs() : -1) {}
+    ~ScopedTimer() { if(start >= 0) record(probe, start, nowNs() - start); }
+
+private:
+    Q_DISABLE_COPY(ScopedTimer)
+    Probe probe;
+    qint64 start;
+};
+
+}
+
+#endif // PROFILER_H
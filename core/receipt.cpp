@@ -0,0 +1,226 @@
+#include "receipt.h"
+#include <climits>
+
+const char *const ReceiptTemplate::DEFAULT =
+    "      MEDICAL STORE RECEIPT\n"
+    "---------------------------------\n"
+    "Receipt: {{number}}\n"
+    "Date: {{date}}\n"
+    "---------------------------------\n"
+    "ITEM             PRICE  QTY   TOTAL\n"
+    "---------------------------------\n"
+    "{{#lines}}{{name<15}} {{price>6}} {{qty>4}} {{amount>7}}\n{{/lines}}"
+    "---------------------------------\n"
+    "GRAND TOTAL: Rs {{total}}\n"
+    "---------------------------------\n"
+    "   Thank you for your purchase!\n";
+
+// --- FORMATTING ---
+// Each writer fills 'buf' and returns the length; all output is ASCII
+static int writeInt(char *buf, qint64 v) {
+    char tmp[24];
+    int n = 0, len = 0;
+    quint64 u = v < 0 ? quint64(0) - quint64(v) : quint64(v);
+    do { tmp[n++] = char('0' + u % 10); u /= 10; } while(u);
+    if(v < 0) buf[len++] = '-';
+    while(n) buf[len++] = tmp[--n];
+    return len;
+}
+
+// Same text as formatRupees()
+static int writeMoney(char *buf, qint64 paisa) {
+    int len = 0;
+    if(paisa < 0) buf[len++] = '-';
+    len += writeInt(buf + len, qAbs(paisa) / 100);
+    const int fraction = int(qAbs(paisa) % 100);
+    buf[len++] = '.';
+    buf[len++] = char('0' + fraction / 10);
+    buf[len++] = char('0' + fraction % 10);
+    return len;
+}
+
+// yyyy-MM-dd HH:mm; nothing for an invalid time
+static int writeDate(char *buf, const QDateTime &time) {
+    if(!time.isValid()) return 0;
+    const QDate d = time.date();
+    const QTime t = time.time();
+    const int parts[] = {d.year(), d.month(), d.day(), t.hour(), t.minute()};
+    const char separators[] = {'-', '-', ' ', ':'};
+    int len = 0;
+    for(int i=0; i<5; ++i) {
+        if(i == 0 && (parts[0] < 0 || parts[0] > 9999)) {
+            len += writeInt(buf, parts[0]);
+        } else if(i == 0) {
+            for(int div=1000; div>0; div/=10) buf[len++] = char('0' + parts[0] / div % 10);
+        } else {
+            buf[len++] = separators[i - 1];
+            buf[len++] = char('0' + parts[i] / 10);
+            buf[len++] = char('0' + parts[i] % 10);
+        }
+    }
+    return len;
+}
+
+static void appendSpaces(QByteArray &out, int n) {
+    for(int i=0; i<n; ++i) out.append(' ');
+}
+
+static void appendPadded(QByteArray &out, const char *text, int len, qint8 align, int width) {
+    const int pad = qMax(0, width - len);
+    if(align > 0) appendSpaces(out, pad);
+    out.append(text, len);
+    if(align < 0) appendSpaces(out, pad);
+}
+
+// UTF-8 of at most 'limit' code points of 'text'
+static void appendUtf8(QByteArray &out, QStringView text, int limit) {
+    int written = 0;
+    for(qsizetype i=0; i<text.size() && written<limit; ++i, ++written) {
+        char32_t cp = text[i].unicode();
+        if(QChar::isHighSurrogate(cp) && i + 1 < text.size() && text[i + 1].isLowSurrogate()) {
+            cp = QChar::surrogateToUcs4(text[i], text[i + 1]);
+            ++i;
+        }
+        if(cp < 0x80) {
+            out.append(char(cp));
+        } else if(cp < 0x800) {
+            out.append(char(0xC0 | (cp >> 6)));
+            out.append(char(0x80 | (cp & 0x3F)));
+        } else if(cp < 0x10000) {
+            out.append(char(0xE0 | (cp >> 12)));
+            out.append(char(0x80 | ((cp >> 6) & 0x3F)));
+            out.append(char(0x80 | (cp & 0x3F)));
+        } else {
+            out.append(char(0xF0 | (cp >> 18)));
+            out.append(char(0x80 | ((cp >> 12) & 0x3F)));
+            out.append(char(0x80 | ((cp >> 6) & 0x3F)));
+            out.append(char(0x80 | (cp & 0x3F)));
+        }
+    }
+}
+
+static int codePoints(QStringView text) {
+    int n = 0;
+    for(qsizetype i=0; i<text.size(); ++i, ++n) {
+        if(text[i].isHighSurrogate() && i + 1 < text.size() && text[i + 1].isLowSurrogate()) ++i;
+    }
+    return n;
+}
+
+// --- RECEIPT TEMPLATE ---
+ReceiptTemplate::ReceiptTemplate(const QString &source) {
+    compile(source);
+    if(!error.isEmpty()) {
+        ops.clear();
+        usesUnits = false;
+    }
+}
+
+void ReceiptTemplate::compile(const QString &source) {
+    static const struct { const char *name; Field field; bool line; } FIELDS[] = {
+        {"number", Number, false}, {"date", Date, false}, {"total", Total, false}, {"items", Items, false},
+        {"units", Units, false}, {"id", LineId, true}, {"name", LineName, true}, {"price", LinePrice, true},
+        {"qty", LineQty, true}, {"amount", LineAmount, true}
+    };
+    const QByteArray text = source.toUtf8();
+    int openLines = -1;
+    int pos = 0;
+    while(pos < text.size()) {
+        const int start = int(text.indexOf("{{", pos));
+        const int stop = start < 0 ? int(text.size()) : start;
+        if(stop > pos) {
+            ops.append({Text, Number, 0, 0, int(literals.size()), stop - pos});
+            literals.append(text.constData() + pos, stop - pos);
+        }
+        if(start < 0) break;
+        const int close = int(text.indexOf("}}", start + 2));
+        if(close < 0) { error = QString("Unclosed {{ at offset %1").arg(start); return; }
+        const QByteArray tag = text.mid(start + 2, close - start - 2).trimmed();
+        pos = close + 2;
+
+        if(tag == "#lines") {
+            if(openLines >= 0) { error = "{{#lines}} cannot be nested"; return; }
+            openLines = ops.size();
+            ops.append({BeginLines, Number, 0, 0, 0, 0});
+            continue;
+        }
+        if(tag == "/lines") {
+            if(openLines < 0) { error = "{{/lines}} without {{#lines}}"; return; }
+            ops[openLines].offset = ops.size();
+            openLines = -1;
+            ops.append({EndLines, Number, 0, 0, 0, 0});
+            continue;
+        }
+
+        QByteArray name = tag;
+        qint8 align = 0;
+        int width = 0;
+        int mark = int(tag.indexOf('<'));
+        if(mark >= 0) align = -1;
+        else if((mark = int(tag.indexOf('>'))) >= 0) align = 1;
+        if(mark >= 0) {
+            bool ok;
+            width = tag.mid(mark + 1).trimmed().toInt(&ok);
+            if(!ok || width <= 0 || width > 255) { error = "Bad width in {{" + QString::fromUtf8(tag) + "}}"; return; }
+            name = tag.left(mark).trimmed();
+        }
+        bool found = false;
+        for(const auto &f : FIELDS) {
+            if(name != f.name) continue;
+            if(f.line && openLines < 0) { error = "{{" + QString::fromUtf8(name) + "}} is only valid inside {{#lines}}"; return; }
+            ops.append({Value, f.field, align, width, 0, 0});
+            usesUnits = usesUnits || f.field == Units;
+            found = true;
+            break;
+        }
+        if(!found) { error = "Unknown field {{" + QString::fromUtf8(name) + "}}"; return; }
+    }
+    if(openLines >= 0) error = "{{#lines}} is not closed";
+}
+
+void ReceiptTemplate::render(const Receipt &receipt, QByteArray &out) const {
+    qint64 units = 0;
+    if(usesUnits) {
+        for(const CartItem &c : receipt.lines) units += c.qty;
+    }
+    renderOps(0, ops.size(), receipt, nullptr, units, out);
+}
+
+void ReceiptTemplate::renderOps(int begin, int end, const Receipt &receipt, const CartItem *line, qint64 units, QByteArray &out) const {
+    char buf[32];
+    for(int i=begin; i<end; ++i) {
+        const Op &op = ops[i];
+        if(op.kind == Text) {
+            out.append(literals.constData() + op.offset, op.length);
+            continue;
+        }
+        if(op.kind == BeginLines) {
+            for(const CartItem &c : receipt.lines) renderOps(i + 1, op.offset, receipt, &c, units, out);
+            i = op.offset;
+            continue;
+        }
+        if(op.kind != Value) continue;
+
+        int len = 0;
+        switch(op.field) {
+        case Number:     len = writeInt(buf, receipt.number); break;
+        case Date:       len = writeDate(buf, receipt.time); break;
+        case Total:      len = writeMoney(buf, receipt.totalPaisa); break;
+        case Items:      len = writeInt(buf, receipt.lines.size()); break;
+        case Units:      len = writeInt(buf, units); break;
+        case LineId:     len = writeInt(buf, line->medId); break;
+        case LinePrice:  len = writeMoney(buf, line->unitPaisa); break;
+        case LineQty:    len = writeInt(buf, line->qty); break;
+        case LineAmount: len = writeMoney(buf, line->lineTotal()); break;
+        case LineName: {
+            const int shown = op.width > 0 ? qMin(op.width, codePoints(line->name)) : codePoints(line->name);
+            const int pad = qMax(0, op.width - shown);
+            if(op.align > 0) appendSpaces(out, pad);
+            appendUtf8(out, line->name, op.width > 0 ? op.width : INT_MAX);
+            if(op.align < 0) appendSpaces(out, pad);
+            continue;
+        }
+        }
+        appendPadded(out, buf, len, op.align, op.width);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef RECEIPT_H
+#define RECEIPT_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "medicine.h"
+
+// --- RECEIPT ---
+// A completed sale. The number is assigned by the ReceiptArchive and
+// counts up from 1.
+struct Receipt {
+    quint32 number = 0;
+    QDateTime time;
+    QVector<CartItem> lines;
+    qint64 totalPaisa = 0;
+
+    friend QDataStream &operator<<(QDataStream &out, const Receipt &r) {
+        return out << r.number << r.time.toMSecsSinceEpoch() << r.lines << r.totalPaisa;
+    }
+    friend QDataStream &operator>>(QDataStream &in, Receipt &r) {
+        qint64 ms;
+        in >> r.number >> ms >> r.lines >> r.totalPaisa;
+        r.time = QDateTime::fromMSecsSinceEpoch(ms);
+        return in;
+    }
+};
+
+// --- RECEIPT TEMPLATE ---
+// Receipt layout compiled once into a flat list of literal runs and field
+// references, then rendered as UTF-8 straight into a caller-owned buffer
+// with no intermediate QStrings, so one buffer can be reused across
+// thousands of receipts.
+//
+//   {{field}}      value as is
+//   {{field<N}}    left-aligned in N columns (text is cut to fit)
+//   {{field>N}}    right-aligned in N columns
+//   {{#lines}} ... {{/lines}}   repeated for every line of the receipt
+//
+// Receipt fields: number, date, total, items, units.
+// Line fields (only inside the lines section): id, name, price, qty, amount.
+class ReceiptTemplate {
+public:
+    static const char *const DEFAULT;
+
+    explicit ReceiptTemplate(const QString &source = QString::fromLatin1(DEFAULT));
+
+    bool isValid() const { return error.isEmpty(); }
+    QString errorString() const { return error; }
+
+    // Appends the rendered receipt to 'out'
+    void render(const Receipt &receipt, QByteArray &out) const;
+
+private:
+    enum Field : quint8 {
+        Number, Date, Total, Items, Units,
+        LineId, LineName, LinePrice, LineQty, LineAmount
+    };
+    enum Kind : quint8 { Text, Value, BeginLines, EndLines };
+
+    struct Op {
+        Kind kind;
+        Field field;
+        // -1 left, 1 right, 0 unpadded
+        qint8 align;
+        int width;
+        // Text: span of 'literals'; BeginLines: index of the matching EndLines
+        int offset;
+        int length;
+    };
+
+    QByteArray literals;
+    QVector<Op> ops;
+    QString error;
+    bool usesUnits = false;
+
+    void compile(const QString &source);
+    void renderOps(int begin, int end, const Receipt &receipt, const CartItem *line, qint64 units, QByteArray &out) const;
+};
+
+#endif // RECEIPT_H
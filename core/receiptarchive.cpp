@@ -0,0 +1,202 @@
+#include "receiptarchive.h"
+#include "fileutil.h"
+#include <QDir>
+#include <QDataStream>
+#include <QtEndian>
+#include <cstring>
+#include <algorithm>
+
+static const int RECORD_HEADER = 8;
+static const int INDEX_ENTRY = 16;
+static const quint32 COMPRESSED = 0x80000000u;
+// Largest run of records fetched with one read while scanning
+static const qint64 SCAN_WINDOW = 1 << 20;
+
+// --- RECEIPT ARCHIVE ---
+ReceiptArchive::ReceiptArchive(const QString &dir) : dirPath(dir) {}
+
+bool ReceiptArchive::open(bool readOnly) {
+    writable = !readOnly;
+    if(writable) QDir().mkpath(dirPath);
+    const QIODevice::OpenMode mode = writable ? QIODevice::ReadWrite : QIODevice::ReadOnly;
+    data.close();
+    index.close();
+    data.setFileName(dirPath + "/receipts.dat");
+    index.setFileName(dirPath + "/receipts.idx");
+    times.clear();
+    offsets.clear();
+    pending.clear();
+    committed = 0;
+    dataEnd = 0;
+    if(readOnly && !data.exists()) return true; // nothing archived yet
+    if(!data.open(mode)) return false;
+    if(!index.open(mode) && writable) return false;
+
+    // The index is written after the data, so it can only trail it. Its
+    // last entry is re-derived from the data file with the rest of the
+    // tail, which also checks that record.
+    const QByteArray raw = index.isOpen() ? index.readAll() : QByteArray();
+    int rows = int(raw.size() / INDEX_ENTRY);
+    times.resize(rows);
+    offsets.resize(rows);
+    for(int i=0; i<rows; ++i) {
+        times[i] = qFromLittleEndian<qint64>(raw.constData() + qint64(i) * INDEX_ENTRY);
+        offsets[i] = qFromLittleEndian<qint64>(raw.constData() + qint64(i) * INDEX_ENTRY + 8);
+    }
+    while(rows > 0 && offsets[rows - 1] >= data.size()) --rows;
+    const qint64 pos = rows > 0 ? offsets[rows - 1] : 0;
+    if(rows > 0) --rows;
+    times.resize(rows);
+    offsets.resize(rows);
+    const int indexed = rows;
+
+    data.seek(pos);
+    const QByteArray tail = data.readAll();
+    qint64 used = 0;
+    Receipt r;
+    while(true) {
+        qint64 len = decode(tail.constData() + used, tail.size() - used, &r);
+        if(len < 0) break;
+        times.append(r.time.toMSecsSinceEpoch());
+        offsets.append(pos + used);
+        used += len;
+    }
+    dataEnd = pos + used;
+    committed = times.size();
+    if(!writable) return true;
+
+    data.resize(dataEnd);
+    data.seek(dataEnd);
+    index.resize(qint64(indexed) * INDEX_ENTRY);
+    index.seek(index.size());
+    QByteArray entries(qint64(times.size() - indexed) * INDEX_ENTRY, Qt::Uninitialized);
+    for(int i=indexed; i<times.size(); ++i) {
+        qToLittleEndian<qint64>(times[i], entries.data() + qint64(i - indexed) * INDEX_ENTRY);
+        qToLittleEndian<qint64>(offsets[i], entries.data() + qint64(i - indexed) * INDEX_ENTRY + 8);
+    }
+    index.write(entries);
+    FileUtil::sync(data);
+    FileUtil::sync(index);
+    return true;
+}
+
+void ReceiptArchive::append(Receipt &receipt) {
+    receipt.number = quint32(times.size() + 1);
+    if(!times.isEmpty() && receipt.time.toMSecsSinceEpoch() < times.last()) receipt.time = QDateTime::fromMSecsSinceEpoch(times.last());
+
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out << receipt;
+    quint32 size = quint32(body.size());
+    // qCompress() prefixes the length, so only receipts with a few lines
+    // or more come out smaller
+    QByteArray packed = qCompress(body, 6);
+    if(packed.size() < body.size()) {
+        body = packed;
+        size = quint32(body.size()) | COMPRESSED;
+    }
+
+    char header[RECORD_HEADER];
+    qToLittleEndian<quint32>(size, header);
+    qToLittleEndian<quint32>(FileUtil::crc32(body.constData(), body.size()), header + 4);
+    times.append(receipt.time.toMSecsSinceEpoch());
+    offsets.append(dataEnd);
+    pending.append(header, RECORD_HEADER);
+    pending.append(body);
+    dataEnd += RECORD_HEADER + body.size();
+}
+
+bool ReceiptArchive::commit() {
+    if(!writable || committed == times.size()) return true;
+    const qint64 onDisk = dataEnd - pending.size();
+    data.seek(onDisk);
+    if(data.write(pending) != pending.size() || !FileUtil::sync(data)) {
+        data.resize(onDisk);
+        return false;
+    }
+    pending.clear();
+
+    QByteArray entries(qint64(times.size() - committed) * INDEX_ENTRY, Qt::Uninitialized);
+    for(int i=committed; i<times.size(); ++i) {
+        qToLittleEndian<qint64>(times[i], entries.data() + qint64(i - committed) * INDEX_ENTRY);
+        qToLittleEndian<qint64>(offsets[i], entries.data() + qint64(i - committed) * INDEX_ENTRY + 8);
+    }
+    // The records are safe now; only their index entries are retried
+    const qint64 indexed = qint64(committed) * INDEX_ENTRY;
+    index.seek(indexed);
+    if(index.write(entries) != entries.size() || !FileUtil::sync(index)) {
+        index.resize(indexed);
+        return false;
+    }
+    committed = times.size();
+    return true;
+}
+
+void ReceiptArchive::close() {
+    commit();
+    data.close();
+    index.close();
+}
+
+// Length of the record at 'record', or -1 if it is cut short or corrupt
+qint64 ReceiptArchive::decode(const char *record, qint64 available, Receipt *receipt) {
+    if(available < RECORD_HEADER) return -1;
+    const quint32 size = qFromLittleEndian<quint32>(record);
+    const quint32 len = size & ~COMPRESSED;
+    if(available - RECORD_HEADER < len) return -1;
+    const char *body = record + RECORD_HEADER;
+    if(FileUtil::crc32(body, len) != qFromLittleEndian<quint32>(record + 4)) return -1;
+
+    QByteArray payload = (size & COMPRESSED) ? qUncompress(reinterpret_cast<const uchar *>(body), len)
+                                             : QByteArray::fromRawData(body, len);
+    QDataStream in(payload);
+    in >> *receipt;
+    if(in.status() != QDataStream::Ok) return -1;
+    return RECORD_HEADER + len;
+}
+
+bool ReceiptArchive::readBytes(qint64 offset, qint64 length, QByteArray &out) const {
+    // Uncommitted records sit at the end of 'pending'
+    const qint64 onDisk = dataEnd - pending.size();
+    out.resize(length);
+    qint64 fromDisk = qBound(qint64(0), onDisk - offset, length);
+    if(fromDisk > 0) {
+        if(!data.seek(offset) || data.read(out.data(), fromDisk) != fromDisk) return false;
+    }
+    if(fromDisk < length) memcpy(out.data() + fromDisk, pending.constData() + (offset + fromDisk - onDisk), length - fromDisk);
+    return true;
+}
+
+bool ReceiptArchive::read(quint32 number, Receipt *receipt) const {
+    if(number < 1 || number > quint32(size())) return false;
+    const int row = int(number - 1);
+    QByteArray record;
+    if(!readBytes(offsets[row], recordEnd(row) - offsets[row], record)) return false;
+    return decode(record.constData(), record.size(), receipt) >= 0;
+}
+
+quint32 ReceiptArchive::firstAt(const QDateTime &time) const {
+    auto it = std::lower_bound(times.constBegin(), times.constEnd(), time.toMSecsSinceEpoch());
+    return quint32(it - times.constBegin()) + 1;
+}
+
+int ReceiptArchive::scan(quint32 first, quint32 last, const std::function<bool(const Receipt &)> &visit) const {
+    const int begin = int(qMax(first, 1u)) - 1;
+    const int end = int(qMin(last, quint32(size()) + 1)) - 1;
+    QByteArray window;
+    Receipt r;
+    int visited = 0;
+    for(int row=begin; row<end; ) {
+        // Records are contiguous, so a run of them is one read
+        int runEnd = row + 1;
+        while(runEnd < end && recordEnd(runEnd) - offsets[row] <= SCAN_WINDOW) ++runEnd;
+        const qint64 start = offsets[row];
+        if(!readBytes(start, recordEnd(runEnd - 1) - start, window)) return visited;
+        for(; row<runEnd; ++row) {
+            if(decode(window.constData() + (offsets[row] - start), recordEnd(row) - offsets[row], &r) < 0) return visited;
+            ++visited;
+            if(!visit(r)) return visited;
+        }
+    }
+    return visited;
+}
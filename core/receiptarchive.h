@@ -0,0 +1,64 @@
+#ifndef RECEIPTARCHIVE_H
+#define RECEIPTARCHIVE_H
+
+#include <QFile>
+#include <QVector>
+#include <QDateTime>
+#include <functional>
+#include "receipt.h"
+
+// --- RECEIPT ARCHIVE ---
+// Append-only store of every issued receipt, so any of them can be
+// reprinted or exported later. receipts.dat holds one record per receipt
+// (8-byte header with size and CRC-32, then the serialized receipt,
+// zlib-compressed when that is smaller). receipts.idx holds a 16-byte
+// entry per receipt (timestamp ms, record offset) and is kept in memory:
+// receipt N is entry N-1, and timestamps are non-decreasing, so both a
+// number and a date range are found without touching the data file.
+//
+// Like the sales ledger, appends are buffered until commit(), which
+// fsyncs both files. A record torn by a crash is cut off on the next
+// open().
+class ReceiptArchive {
+public:
+    explicit ReceiptArchive(const QString &dir);
+
+    // A read-only archive may be opened next to the writer (say, on an
+    // export thread) and sees what was committed up to then
+    bool open(bool readOnly = false);
+    // Numbers the receipt and keeps its time non-decreasing
+    void append(Receipt &receipt);
+    // Writes and fsyncs the receipts appended since the last commit;
+    // false if that failed, in which case they are retried next time
+    bool commit();
+    // Commits and lets go of both files
+    void close();
+    int size() const { return times.size(); }
+
+    bool read(quint32 number, Receipt *receipt) const;
+    // Receipts issued in [from, to) are numbered [firstAt(from), firstAt(to))
+    quint32 firstAt(const QDateTime &time) const;
+    // Decodes receipts [first, last) in order, reading runs of records in
+    // one go; stops early when 'visit' returns false. Returns the number
+    // of receipts visited.
+    int scan(quint32 first, quint32 last, const std::function<bool(const Receipt &)> &visit) const;
+    // Bytes of receipts.dat, including uncommitted records
+    qint64 dataSize() const { return dataEnd; }
+
+private:
+    QString dirPath;
+    bool writable = false;
+    mutable QFile data;
+    QFile index;
+    QVector<qint64> times;
+    QVector<qint64> offsets;
+    QByteArray pending;
+    qint64 dataEnd = 0;
+    int committed = 0;
+
+    qint64 recordEnd(int row) const { return row + 1 < offsets.size() ? offsets[row + 1] : dataEnd; }
+    bool readBytes(qint64 offset, qint64 length, QByteArray &out) const;
+    static qint64 decode(const char *record, qint64 available, Receipt *receipt);
+};
+
+#endif // RECEIPTARCHIVE_H
@@ -0,0 +1,246 @@
+#include "receiptspooler.h"
+#include "receiptarchive.h"
+#include "profiler.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// 80 mm roll; 8 pt Courier fits 45 columns between the margins
+static const int PDF_WIDTH = 226;
+static const int PDF_MARGIN = 12;
+static const int PDF_LEADING = 10;
+static const qint64 WRITE_CHUNK = 1 << 16;
+
+// UTF-8 down to one byte per character; anything above 'highest' is '?'
+static void appendNarrow(QByteArray &out, const char *s, qsizetype n, uint highest) {
+    for(qsizetype i=0; i<n; ) {
+        const uchar c = uchar(s[i]);
+        if(c < 0x80) { out.append(char(c)); ++i; continue; }
+        const int len = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+        uint cp = c >= 0xF0 ? c & 0x07 : c >= 0xE0 ? c & 0x0F : c & 0x1F;
+        for(int k=1; k<len && i+k<n; ++k) cp = (cp << 6) | (uchar(s[i + k]) & 0x3F);
+        out.append(cp >= 0xA0 && cp <= highest ? char(cp) : '?');
+        i += len;
+    }
+}
+
+// --- PAGE WRITER ---
+// Streams rendered receipts to a device in one of the spooler's formats.
+// PDF objects are numbered 1 catalog, 2 page tree, 3 font, then a page
+// and its content stream per receipt; the page tree and the xref table
+// go out last, once every page offset is known.
+namespace {
+
+class PageWriter {
+public:
+    PageWriter(QIODevice *out, ReceiptSpooler::Format format) : out(out), format(format) {}
+
+    void add(const QByteArray &rendered) {
+        switch(format) {
+        case ReceiptSpooler::PlainText:
+            if(pages > 0) write("\f");
+            write(rendered);
+            break;
+        case ReceiptSpooler::EscPos:
+            if(pages == 0) write("\x1B@");
+            line.resize(0);
+            appendNarrow(line, rendered.constData(), rendered.size(), 0x7F);
+            write(line);
+            // Feed four lines, then a partial cut
+            write(QByteArray("\x1B" "d" "\x04" "\x1D" "V" "\x01", 6));
+            break;
+        case ReceiptSpooler::Pdf:
+            if(pages == 0) beginPdf();
+            addPdfPage(rendered);
+            break;
+        }
+        ++pages;
+    }
+
+    bool finish() {
+        if(format == ReceiptSpooler::Pdf) {
+            if(pages == 0) beginPdf();
+            finishPdf();
+        }
+        flushChunk();
+        return ok;
+    }
+
+private:
+    QIODevice *out;
+    ReceiptSpooler::Format format;
+    int pages = 0;
+    qint64 written = 0;
+    bool ok = true;
+    QByteArray chunk;
+    QByteArray line;
+    QByteArray content;
+    // Offset of object N at N - 1
+    QVector<qint64> objectOffsets;
+
+    void write(const QByteArray &bytes) {
+        chunk.append(bytes);
+        written += bytes.size();
+        if(chunk.size() >= WRITE_CHUNK) flushChunk();
+    }
+
+    void flushChunk() {
+        if(chunk.isEmpty()) return;
+        ok = ok && out->write(chunk) == chunk.size();
+        chunk.resize(0);
+    }
+
+    void writeObject(int number, const QByteArray &body) {
+        if(objectOffsets.size() < number) objectOffsets.resize(number);
+        objectOffsets[number - 1] = written;
+        write(QByteArray::number(number) + " 0 obj\n");
+        write(body);
+        write("\nendobj\n");
+    }
+
+    void beginPdf() {
+        write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+        writeObject(1, "<< /Type /Catalog /Pages 2 0 R >>");
+        writeObject(3, "<< /Type /Font /Subtype /Type1 /BaseFont /Courier /Encoding /WinAnsiEncoding >>");
+    }
+
+    void addPdfPage(const QByteArray &rendered) {
+        const int lines = int(rendered.count('\n')) + int(!rendered.endsWith('\n'));
+        const int height = 2 * PDF_MARGIN + qMax(1, lines) * PDF_LEADING;
+        content = "BT /F1 8 Tf " + QByteArray::number(PDF_LEADING) + " TL " + QByteArray::number(PDF_MARGIN) + " "
+                  + QByteArray::number(height - PDF_MARGIN) + " Td\n";
+        qsizetype start = 0;
+        while(start < rendered.size()) {
+            qsizetype end = rendered.indexOf('\n', start);
+            if(end < 0) end = rendered.size();
+            line.resize(0);
+            appendNarrow(line, rendered.constData() + start, end - start, 0xFF);
+            content += '(';
+            for(char c : line) {
+                if(c == '(' || c == ')' || c == '\\') content += '\\';
+                content += c;
+            }
+            content += ") '\n";
+            start = end + 1;
+        }
+        content += "ET";
+
+        const int page = 4 + 2 * pages;
+        writeObject(page, "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " + QByteArray::number(PDF_WIDTH) + " "
+                          + QByteArray::number(height) + "] /Resources << /Font << /F1 3 0 R >> >> /Contents "
+                          + QByteArray::number(page + 1) + " 0 R >>");
+        writeObject(page + 1, "<< /Length " + QByteArray::number(content.size()) + " >>\nstream\n" + content + "\nendstream");
+    }
+
+    void finishPdf() {
+        QByteArray kids;
+        for(int p=0; p<pages; ++p) kids += QByteArray::number(4 + 2 * p) + " 0 R ";
+        writeObject(2, "<< /Type /Pages /Kids [" + kids + "] /Count " + QByteArray::number(pages) + " >>");
+
+        const qint64 xref = written;
+        write("xref\n0 " + QByteArray::number(objectOffsets.size() + 1) + "\n0000000000 65535 f \n");
+        for(qint64 offset : objectOffsets) write(QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n");
+        write("trailer\n<< /Size " + QByteArray::number(objectOffsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n"
+              + QByteArray::number(xref) + "\n%%EOF\n");
+    }
+};
+
+}
+
+// --- RECEIPT SPOOLER ---
+ReceiptSpooler::ReceiptSpooler(const QString &archiveDir, QObject *parent) : QObject(parent), archiveDir(archiveDir) {}
+
+bool ReceiptSpooler::parseFormat(const QString &name, Format *format) {
+    const QString n = name.toLower();
+    if(n == "text" || n == "txt") *format = PlainText;
+    else if(n == "pdf") *format = Pdf;
+    else if(n == "escpos" || n == "esc-pos") *format = EscPos;
+    else return false;
+    return true;
+}
+
+QString ReceiptSpooler::suffix(Format format) {
+    switch(format) {
+    case Pdf:    return "pdf";
+    case EscPos: return "prn";
+    default:     return "txt";
+    }
+}
+
+QByteArray ReceiptSpooler::encode(Format format, const QByteArray &rendered) {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    PageWriter writer(&buffer, format);
+    writer.add(rendered);
+    writer.finish();
+    return buffer.data();
+}
+
+void ReceiptSpooler::setTemplate(const QString &source) {
+    ReceiptTemplate compiled(source);
+    if(!compiled.isValid()) {
+        emit templateError(compiled.errorString());
+        return;
+    }
+    layout = compiled;
+}
+
+void ReceiptSpooler::print(const Receipt &receipt, ReceiptSpooler::Format format, const QString &destination) {
+    Profiler::ScopedTimer timer(Profiler::ReceiptPrint);
+    text.resize(0);
+    layout.render(receipt, text);
+
+    QString path = destination;
+    if(QFileInfo(destination).isDir()) {
+        path = QDir(destination).filePath(QString("receipt-%1.%2").arg(receipt.number, 8, 10, QChar('0')).arg(suffix(format)));
+    }
+    // A PDF is a whole document, so it replaces the file; text and
+    // printer bytes are appended, which also suits a device node
+    QFile file(path);
+    const QIODevice::OpenMode mode = format == Pdf ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::WriteOnly | QIODevice::Append;
+    if(!file.open(mode)) {
+        emit printed(false, receipt.number, "Cannot write to " + path);
+        return;
+    }
+    PageWriter writer(&file, format);
+    writer.add(text);
+    const bool ok = writer.finish() && file.flush();
+    emit printed(ok, receipt.number, ok ? path : "Cannot write to " + path);
+}
+
+void ReceiptSpooler::exportRange(const QDateTime &from, const QDateTime &to, ReceiptSpooler::Format format, const QString &path) {
+    Profiler::ScopedTimer timer(Profiler::ReceiptExport);
+    ReceiptArchive archive(archiveDir);
+    if(!archive.open(true)) {
+        emit exported(false, 0, "Cannot open the receipt archive");
+        return;
+    }
+    const quint32 first = archive.firstAt(from);
+    const quint32 last = qMax(first, archive.firstAt(to));
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        emit exported(false, 0, "Cannot write to " + path);
+        return;
+    }
+
+    PageWriter writer(&file, format);
+    const qint64 total = last - first;
+    emit progress(0, total);
+    const int done = archive.scan(first, last, [&](const Receipt &r) {
+        text.resize(0);
+        layout.render(r, text);
+        writer.add(text);
+        if(qint64(r.number - first + 1) % 256 == 0) emit progress(r.number - first + 1, total);
+        return true;
+    });
+    if(done != total) {
+        file.cancelWriting();
+        emit exported(false, done, QString("Receipt %1 cannot be read from the archive").arg(first + done));
+        return;
+    }
+    const bool ok = writer.finish() && file.commit();
+    emit progress(total, total);
+    emit exported(ok, done, ok ? path : "Cannot write to " + path);
+}
@@ -0,0 +1,58 @@
+#ifndef RECEIPTSPOOLER_H
+#define RECEIPTSPOOLER_H
+
+#include <QObject>
+#include <QDateTime>
+#include "receipt.h"
+
+// --- RECEIPT SPOOLER ---
+// Turns receipts into printable output off the counter's thread. Every
+// receipt is rendered with the compiled ReceiptTemplate into one reused
+// buffer and then written as:
+//   PlainText  UTF-8, receipts separated by a form feed
+//   Pdf        one 80 mm page per receipt in built-in Courier
+//   EscPos     raw bytes for thermal receipt printers (feed and cut after
+//              each receipt)
+// PDF and ESC/POS cannot carry every character; anything outside Latin-1
+// (PDF) or ASCII (ESC/POS) is printed as '?'.
+//
+// Meant to live on a worker thread; calls made through queued
+// connections form the print queue, so a slow printer only delays later
+// jobs, never a checkout.
+class ReceiptSpooler : public QObject {
+    Q_OBJECT
+
+public:
+    enum Format { PlainText, Pdf, EscPos };
+
+    explicit ReceiptSpooler(const QString &archiveDir, QObject *parent = nullptr);
+
+    // "text", "pdf" or "escpos"
+    static bool parseFormat(const QString &name, Format *format);
+    static QString suffix(Format format);
+    // One rendered receipt in 'format'
+    static QByteArray encode(Format format, const QByteArray &rendered);
+
+public slots:
+    // An invalid template is reported through templateError() and the
+    // previous one stays in use
+    void setTemplate(const QString &source);
+    // 'destination' is a directory (one file per receipt), or a file or
+    // printer device that receipts are appended to
+    void print(const Receipt &receipt, ReceiptSpooler::Format format, const QString &destination);
+    // Re-renders the archived receipts issued in [from, to) into one file
+    void exportRange(const QDateTime &from, const QDateTime &to, ReceiptSpooler::Format format, const QString &path);
+
+signals:
+    void templateError(const QString &message);
+    void printed(bool ok, quint32 number, const QString &message);
+    void progress(qint64 done, qint64 total);
+    void exported(bool ok, int count, const QString &message);
+
+private:
+    QString archiveDir;
+    ReceiptTemplate layout;
+    QByteArray text;
+};
+
+#endif // RECEIPTSPOOLER_H
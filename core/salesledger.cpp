@@ -0,0 +1,151 @@
+#include "salesledger.h"
+#include "fileutil.h"
+#include <QDir>
+#include <QtEndian>
+#include <algorithm>
+
+static const char *COLUMN_FILES[] = {"ts.col", "med.col", "qty.col", "price.col"};
+static const qint64 COLUMN_WIDTHS[] = {8, 4, 4, 8};
+
+template <typename T>
+static QVector<T> readColumn(QFile &file, int rows) {
+    QVector<T> col(rows);
+    file.seek(0);
+    QByteArray raw = file.read(qint64(rows) * sizeof(T));
+    for(int i=0; i<rows; ++i) col[i] = qFromLittleEndian<T>(raw.constData() + qint64(i) * sizeof(T));
+    return col;
+}
+
+template <typename T>
+static bool writeValues(QFile &file, const QVector<T> &col, int from) {
+    QByteArray raw((col.size() - from) * qsizetype(sizeof(T)), Qt::Uninitialized);
+    for(int i=from; i<col.size(); ++i) qToLittleEndian<T>(col[i], raw.data() + qint64(i - from) * sizeof(T));
+    return file.write(raw) == raw.size() && FileUtil::sync(file);
+}
+
+// --- SALES LEDGER ---
+SalesLedger::SalesLedger(const QString &dir) : dirPath(dir) {}
+
+bool SalesLedger::open() {
+    QDir().mkpath(dirPath);
+    for(int c=0; c<ColumnCount; ++c) {
+        files[c].close();
+        files[c].setFileName(dirPath + "/" + COLUMN_FILES[c]);
+        if(!files[c].open(QIODevice::ReadWrite)) return false;
+    }
+
+    // A crash between column writes leaves some columns one row longer;
+    // the shortest column decides how many rows are complete.
+    qint64 rows = std::min({files[ColTime].size() / 8, files[ColMed].size() / 4,
+                            files[ColQty].size() / 4, files[ColPrice].size() / 8});
+    timestamps = readColumn<qint64>(files[ColTime], int(rows));
+    medIds = readColumn<qint32>(files[ColMed], int(rows));
+    quantities = readColumn<qint32>(files[ColQty], int(rows));
+    prices = readColumn<qint64>(files[ColPrice], int(rows));
+
+    for(int c=0; c<ColumnCount; ++c) {
+        files[c].resize(rows * COLUMN_WIDTHS[c]);
+        files[c].seek(files[c].size());
+    }
+    committed = int(rows);
+    return true;
+}
+
+void SalesLedger::close() {
+    commit();
+    for(int c=0; c<ColumnCount; ++c) files[c].close();
+}
+
+void SalesLedger::append(qint64 timestamp, int medId, int qty, qint64 unitPaisa) {
+    if(!timestamps.isEmpty()) timestamp = qMax(timestamp, timestamps.last());
+    timestamps.append(timestamp);
+    medIds.append(medId);
+    quantities.append(qty);
+    prices.append(unitPaisa);
+}
+
+bool SalesLedger::commit() {
+    if(committed == timestamps.size()) return true;
+    if(writeValues(files[ColTime], timestamps, committed) && writeValues(files[ColMed], medIds, committed)
+       && writeValues(files[ColQty], quantities, committed) && writeValues(files[ColPrice], prices, committed)) {
+        committed = timestamps.size();
+        return true;
+    }
+    // Drop the partly written rows so the retry lines the columns up again
+    for(int c=0; c<ColumnCount; ++c) {
+        files[c].resize(committed * COLUMN_WIDTHS[c]);
+        files[c].seek(files[c].size());
+    }
+    return false;
+}
+
+int SalesLedger::lowerBound(qint64 ts) const {
+    return int(std::lower_bound(timestamps.constBegin(), timestamps.constEnd(), ts) - timestamps.constBegin());
+}
+
+qint64 SalesLedger::sumRange(int begin, int end) const {
+    const qint32 *q = quantities.constData();
+    const qint64 *p = prices.constData();
+    qint64 sum = 0;
+    for(int i=begin; i<end; ++i) sum += qint64(q[i]) * p[i];
+    return sum;
+}
+
+qint64 SalesLedger::revenue(const QDateTime &from, const QDateTime &to) const {
+    return sumRange(lowerBound(from.toMSecsSinceEpoch()), lowerBound(to.toMSecsSinceEpoch()));
+}
+
+QMap<QDate, qint64> SalesLedger::dailyRevenue(const QDate &first, const QDate &last) const {
+    QMap<QDate, qint64> result;
+    int begin = lowerBound(first.startOfDay().toMSecsSinceEpoch());
+    for(QDate d = first; d <= last; d = d.addDays(1)) {
+        int end = lowerBound(d.addDays(1).startOfDay().toMSecsSinceEpoch());
+        result.insert(d, sumRange(begin, end));
+        begin = end;
+    }
+    return result;
+}
+
+QMap<QDate, qint64> SalesLedger::monthlyRevenue(const QDate &first, const QDate &last) const {
+    QMap<QDate, qint64> result;
+    QDate month(first.year(), first.month(), 1);
+    int begin = lowerBound(month.startOfDay().toMSecsSinceEpoch());
+    for(; month <= last; month = month.addMonths(1)) {
+        int end = lowerBound(month.addMonths(1).startOfDay().toMSecsSinceEpoch());
+        result.insert(month, sumRange(begin, end));
+        begin = end;
+    }
+    return result;
+}
+
+QHash<int, SalesLedger::Seller> SalesLedger::perMedicine(const QDateTime &from, const QDateTime &to) const {
+    QHash<int, Seller> totals;
+    int end = lowerBound(to.toMSecsSinceEpoch());
+    for(int i=lowerBound(from.toMSecsSinceEpoch()); i<end; ++i) {
+        Seller &s = totals[medIds[i]];
+        s.medId = medIds[i];
+        s.qty += quantities[i];
+        s.revenue += qint64(quantities[i]) * prices[i];
+    }
+    return totals;
+}
+
+QVector<SalesLedger::Seller> SalesLedger::topSellers(int n, const QDateTime &from, const QDateTime &to) const {
+    QHash<int, Seller> totals = perMedicine(from, to);
+    QVector<Seller> list(totals.cbegin(), totals.cend());
+    auto byQty = [](const Seller &a, const Seller &b) { return a.qty != b.qty ? a.qty > b.qty : a.revenue > b.revenue; };
+    int k = qMin(n, int(list.size()));
+    std::partial_sort(list.begin(), list.begin() + k, list.end(), byQty);
+    list.resize(k);
+    return list;
+}
+
+QMap<QString, qint64> SalesLedger::companyRevenue(const InventoryStore &store, const QDateTime &from, const QDateTime &to) const {
+    QMap<QString, qint64> result;
+    const QHash<int, Seller> totals = perMedicine(from, to);
+    for(const Seller &s : totals) {
+        int slot = store.slotOf(s.medId);
+        result[slot >= 0 ? store.companyAt(slot) : QString("(deleted)")] += s.revenue;
+    }
+    return result;
+}
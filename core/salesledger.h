@@ -0,0 +1,60 @@
+#ifndef SALESLEDGER_H
+#define SALESLEDGER_H
+
+#include <QVector>
+#include <QFile>
+#include <QMap>
+#include <QHash>
+#include <QDate>
+#include "inventorystore.h"
+
+// --- SALES LEDGER ---
+// Append-only, columnar record of every checkout line. Each column is its
+// own file of packed little-endian values (timestamp ms, medicine id,
+// quantity, unit price in paisa) and is kept in memory as a plain array,
+// so aggregates are tight loops over contiguous data. Timestamps are kept
+// non-decreasing, which lets every date-range query binary-search its
+// bounds instead of scanning the whole ledger.
+class SalesLedger {
+public:
+    struct Seller {
+        int medId = 0;
+        qint64 qty = 0;
+        qint64 revenue = 0;
+    };
+
+    explicit SalesLedger(const QString &dir);
+
+    bool open();
+    void append(qint64 timestamp, int medId, int qty, qint64 unitPaisa);
+    // Writes and fsyncs the rows appended since the last commit. On
+    // failure the files are cut back and the rows retried next time.
+    bool commit();
+    // Commits and lets go of the column files; the rows stay in memory
+    void close();
+    int size() const { return timestamps.size(); }
+
+    // All revenue figures are in paisa; ranges are [from, to)
+    qint64 revenue(const QDateTime &from, const QDateTime &to) const;
+    QMap<QDate, qint64> dailyRevenue(const QDate &first, const QDate &last) const;
+    QMap<QDate, qint64> monthlyRevenue(const QDate &first, const QDate &last) const;
+    QVector<Seller> topSellers(int n, const QDateTime &from, const QDateTime &to) const;
+    QHash<int, Seller> perMedicine(const QDateTime &from, const QDateTime &to) const;
+    QMap<QString, qint64> companyRevenue(const InventoryStore &store, const QDateTime &from, const QDateTime &to) const;
+
+private:
+    enum Column { ColTime, ColMed, ColQty, ColPrice, ColumnCount };
+
+    QString dirPath;
+    QFile files[ColumnCount];
+    QVector<qint64> timestamps;
+    QVector<qint32> medIds;
+    QVector<qint32> quantities;
+    QVector<qint64> prices;
+    int committed = 0;
+
+    int lowerBound(qint64 ts) const;
+    qint64 sumRange(int begin, int end) const;
+};
+
+#endif // SALESLEDGER_H
@@ -0,0 +1,160 @@
+#include "searchindex.h"
+#include "profiler.h"
+#include <algorithm>
+
+// --- SEARCH INDEX ---
+quint64 SearchIndex::gramAt(const QString &s, int pos) {
+    return (quint64(s.at(pos).unicode()) << 32) | (quint64(s.at(pos + 1).unicode()) << 16) | quint64(s.at(pos + 2).unicode());
+}
+
+void SearchIndex::addGrams(PostingMap &map, const QString &s, int id) {
+    for(int i=0; i + 3 <= s.size(); ++i) {
+        QVector<int> &list = map[gramAt(s, i)];
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if(it == list.end() || *it != id) list.insert(it, id);
+    }
+}
+
+void SearchIndex::appendGrams(PostingMap &map, const QString &s, int id) {
+    for(int i=0; i + 3 <= s.size(); ++i) map[gramAt(s, i)].append(id);
+}
+
+// A gram repeated within one name leaves the same id twice in a row
+void SearchIndex::sortPostings(PostingMap &map) {
+    for(auto it = map.begin(); it != map.end(); ++it) {
+        QVector<int> &list = it.value();
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+    }
+}
+
+void SearchIndex::dropGrams(PostingMap &map, const QString &s, int id) {
+    for(int i=0; i + 3 <= s.size(); ++i) {
+        auto found = map.find(gramAt(s, i));
+        if(found == map.end()) continue;
+        QVector<int> &list = found.value();
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if(it != list.end() && *it == id) list.erase(it);
+        if(list.isEmpty()) map.erase(found);
+    }
+}
+
+const QVector<int> *SearchIndex::rarestList(const PostingMap &map, const QString &query) {
+    static const QVector<int> none;
+    const QVector<int> *best = nullptr;
+    for(int i=0; i + 3 <= query.size(); ++i) {
+        auto found = map.constFind(gramAt(query, i));
+        if(found == map.constEnd()) return &none;
+        if(!best || found.value().size() < best->size()) best = &found.value();
+    }
+    return best;
+}
+
+void SearchIndex::insert(int id, const QString &name) {
+    remove(id);
+    Entry e{fold(name), QString::number(id)};
+    addGrams(nameGrams, e.folded, id);
+    addGrams(idGrams, e.digits, id);
+    entries.insert(id, e);
+}
+
+void SearchIndex::remove(int id) {
+    auto found = entries.find(id);
+    if(found == entries.end()) return;
+    dropGrams(nameGrams, found->folded, id);
+    dropGrams(idGrams, found->digits, id);
+    entries.erase(found);
+}
+
+void SearchIndex::clear() {
+    entries.clear();
+    nameGrams.clear();
+    idGrams.clear();
+}
+
+void SearchIndex::build(const InventoryStore &store) {
+    clear();
+    entries.reserve(store.size());
+    for(int slot=0; slot<store.size(); ++slot) {
+        const int id = store.idAt(slot);
+        Entry e{fold(store.nameAt(slot)), QString::number(id)};
+        appendGrams(nameGrams, e.folded, id);
+        appendGrams(idGrams, e.digits, id);
+        entries.insert(id, e);
+    }
+    sortPostings(nameGrams);
+    sortPostings(idGrams);
+}
+
+bool SearchIndex::matches(const Entry &e, const QString &query, bool numeric) const {
+    return e.folded.contains(query) || (numeric && e.digits.contains(query));
+}
+
+QVector<int> SearchIndex::search(const QString &query, const QVector<int> *within) const {
+    QVector<int> result;
+    bool numeric = !query.isEmpty() && std::all_of(query.begin(), query.end(), [](QChar c) { return c.isDigit(); });
+
+    if(within) {
+        for(int id : *within) {
+            auto found = entries.constFind(id);
+            if(found != entries.constEnd() && matches(found.value(), query, numeric)) result.append(id);
+        }
+        return result;
+    }
+
+    if(query.size() < 3) {
+        for(auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+            if(matches(it.value(), query, numeric)) result.append(it.key());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Candidates come from the rarest trigram; each one is then verified
+    // because trigrams alone do not guarantee they appear contiguously.
+    QVector<int> byName;
+    for(int id : *rarestList(nameGrams, query)) {
+        if(entries.constFind(id)->folded.contains(query)) byName.append(id);
+    }
+    if(!numeric) return byName;
+
+    QVector<int> byId;
+    for(int id : *rarestList(idGrams, query)) {
+        if(entries.constFind(id)->digits.contains(query)) byId.append(id);
+    }
+    result.resize(byName.size() + byId.size());
+    result.erase(std::set_union(byName.begin(), byName.end(), byId.begin(), byId.end(), result.begin()), result.end());
+    return result;
+}
+
+// --- SEARCH ENGINE ---
+void SearchEngine::rebuild(const InventoryStore &snapshot) {
+    Profiler::ScopedTimer timer(Profiler::SearchRebuild);
+    index.build(snapshot);
+    ++revision;
+}
+
+void SearchEngine::insert(int id, const QString &name) {
+    index.insert(id, name);
+    ++revision;
+}
+
+void SearchEngine::remove(int id) {
+    index.remove(id);
+    ++revision;
+}
+
+void SearchEngine::runQuery(quint64 ticket, const QString &query) {
+    Profiler::ScopedTimer timer(Profiler::SearchQuery);
+    QString folded = SearchIndex::fold(query);
+
+    // Extending the previous query can only shrink its result set
+    bool narrow = revision == lastRevision && !lastQuery.isEmpty() && folded.contains(lastQuery);
+    QVector<int> ids = index.search(folded, narrow ? &lastIds : nullptr);
+
+    lastQuery = folded;
+    lastIds = ids;
+    lastRevision = revision;
+    Profiler::count(Profiler::SearchHits, ids.size());
+    emit resultsReady(ticket, ids);
+}
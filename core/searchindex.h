@@ -0,0 +1,81 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include "inventorystore.h"
+
+// --- SEARCH INDEX ---
+// Trigram index over case-folded names plus a second one over the decimal
+// ID digits. A query of three or more characters only verifies the ids in
+// its rarest trigram's posting list; shorter queries fall back to a scan of
+// the pre-folded strings, which never allocates per record.
+class SearchIndex {
+public:
+    void insert(int id, const QString &name);
+    void remove(int id);
+    void clear();
+    // Replaces the index with every record of 'store'. Postings are
+    // appended as they come and sorted once per list at the end, rather
+    // than kept sorted one insert at a time.
+    void build(const InventoryStore &store);
+    int size() const { return entries.size(); }
+
+    // Sorted ids whose name or ID contains the query. When 'within' is
+    // given only those ids are verified (used to narrow a previous result).
+    QVector<int> search(const QString &foldedQuery, const QVector<int> *within = nullptr) const;
+
+    static QString fold(const QString &text) { return text.toCaseFolded(); }
+
+private:
+    struct Entry {
+        QString folded;
+        QString digits;
+    };
+    typedef QHash<quint64, QVector<int>> PostingMap;
+
+    QHash<int, Entry> entries;
+    PostingMap nameGrams;
+    PostingMap idGrams;
+
+    static quint64 gramAt(const QString &s, int pos);
+    static void addGrams(PostingMap &map, const QString &s, int id);
+    static void appendGrams(PostingMap &map, const QString &s, int id);
+    static void sortPostings(PostingMap &map);
+    static void dropGrams(PostingMap &map, const QString &s, int id);
+    static const QVector<int> *rarestList(const PostingMap &map, const QString &query);
+    bool matches(const Entry &e, const QString &query, bool numeric) const;
+};
+
+// --- SEARCH ENGINE ---
+// Owns the index and lives on a worker thread. Every call is queued to that
+// thread, so index updates and queries run in the order the GUI issued them
+// and the index itself needs no locking. Results come back via resultsReady().
+class SearchEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SearchEngine(QObject *parent = nullptr) : QObject(parent) {}
+
+public slots:
+    void rebuild(const InventoryStore &snapshot);
+    void insert(int id, const QString &name);
+    void remove(int id);
+    void runQuery(quint64 ticket, const QString &query);
+
+signals:
+    void resultsReady(quint64 ticket, const QVector<int> &ids);
+
+private:
+    SearchIndex index;
+    quint64 revision = 0;
+
+    // Last evaluated query, reused when the clerk keeps typing
+    QString lastQuery;
+    QVector<int> lastIds;
+    quint64 lastRevision = 0;
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,76 @@
+#include "stockreservations.h"
+#include "profiler.h"
+
+// --- STOCK RESERVATIONS ---
+void StockReservations::load(const InventoryStore &store) {
+    QWriteLocker locker(&lock);
+    items.clear();
+    storage.clear();
+    items.reserve(store.size());
+    for(int slot=0; slot<store.size(); ++slot) {
+        storage.emplace_back();
+        Item &it = storage.back();
+        it.available.storeRelaxed(store.stockAt(slot));
+        it.name = store.nameAt(slot);
+        it.unitPaisa = toPaisa(store.priceAt(slot));
+        items.insert(store.idAt(slot), &it);
+    }
+}
+
+void StockReservations::set(const Medicine &m, int available) {
+    QWriteLocker locker(&lock);
+    Item *it = item(m.id);
+    if(!it) {
+        storage.emplace_back();
+        it = &storage.back();
+        items.insert(m.id, it);
+    }
+    it->available.storeRelease(available);
+    it->name = m.name;
+    it->unitPaisa = toPaisa(m.price);
+}
+
+void StockReservations::remove(int id) {
+    QWriteLocker locker(&lock);
+    items.remove(id);
+}
+
+bool StockReservations::reserve(int id, int qty) {
+    if(qty <= 0) return false;
+    QReadLocker locker(&lock);
+    Item *it = item(id);
+    if(!it) return false;
+    int current = it->available.loadAcquire();
+    while(current >= qty) {
+        if(it->available.testAndSetOrdered(current, current - qty, current)) return true;
+    }
+    Profiler::count(Profiler::ReservationsRefused);
+    return false;
+}
+
+void StockReservations::release(int id, int qty) {
+    if(qty <= 0) return;
+    QReadLocker locker(&lock);
+    if(Item *it = item(id)) it->available.fetchAndAddOrdered(qty);
+}
+
+bool StockReservations::contains(int id) const {
+    QReadLocker locker(&lock);
+    return items.contains(id);
+}
+
+int StockReservations::available(int id) const {
+    QReadLocker locker(&lock);
+    Item *it = item(id);
+    return it ? it->available.loadAcquire() : -1;
+}
+
+bool StockReservations::lookup(int id, QString *name, qint64 *unitPaisa, int *available) const {
+    QReadLocker locker(&lock);
+    Item *it = item(id);
+    if(!it) return false;
+    if(name) *name = it->name;
+    if(unitPaisa) *unitPaisa = it->unitPaisa;
+    if(available) *available = it->available.loadAcquire();
+    return true;
+}
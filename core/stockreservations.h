@@ -0,0 +1,49 @@
+#ifndef STOCKRESERVATIONS_H
+#define STOCKRESERVATIONS_H
+
+#include <QHash>
+#include <QAtomicInt>
+#include <QReadWriteLock>
+#include <deque>
+#include "inventorystore.h"
+
+// --- STOCK RESERVATIONS ---
+// Unreserved stock per medicine, shared by every billing counter. Each
+// item has its own atomic counter, so a reservation is a single
+// compare-and-swap and counters working on different items never contend.
+// The id -> item table is guarded by a read/write lock that is only taken
+// for writing when items are added, changed or removed.
+//
+// Items live in a deque so their addresses stay stable while the table
+// grows; removed items are unlinked from the table but not freed.
+class StockReservations {
+public:
+    struct Item {
+        QAtomicInt available;
+        QString name;
+        qint64 unitPaisa = 0;
+    };
+
+    void load(const InventoryStore &store);
+    // Adds or replaces an item with 'available' unreserved units
+    void set(const Medicine &m, int available);
+    void remove(int id);
+
+    // Takes 'qty' units if that many are unreserved; never goes negative
+    bool reserve(int id, int qty);
+    void release(int id, int qty);
+
+    bool contains(int id) const;
+    // Unreserved units, or -1 for an unknown id
+    int available(int id) const;
+    bool lookup(int id, QString *name, qint64 *unitPaisa, int *available) const;
+
+private:
+    mutable QReadWriteLock lock;
+    QHash<int, Item *> items;
+    std::deque<Item> storage;
+
+    Item *item(int id) const { return items.value(id, nullptr); }
+};
+
+#endif // STOCKRESERVATIONS_H
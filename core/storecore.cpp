@@ -0,0 +1,387 @@
+#include "storecore.h"
+#include "profiler.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+static const char *FILE_NAME = "medicines.inv";
+static const char *LEGACY_FILE_NAME = "medicines.dat";
+static const char *SALES_DIR = "sales";
+static const char *RECEIPTS_DIR = "receipts";
+static const char *LOCK_FILE_NAME = "medicines.lock";
+
+// --- STORE CORE ---
+StoreCore::StoreCore(const QString &dataDir, QObject *parent)
+    : QObject(parent), dir(dataDir), sales(dataPath(SALES_DIR)), receipts(dataPath(RECEIPTS_DIR)) {}
+
+StoreCore::~StoreCore() {
+    abandonLoad();
+}
+
+QString StoreCore::dataPath(const QString &name) const {
+    return dir.isEmpty() ? name : QDir(dir).filePath(name);
+}
+
+bool StoreCore::lockData() {
+    if(!dir.isEmpty()) QDir().mkpath(dir);
+    error.clear();
+    if(dataLock) return true;
+    dataLock.reset(new QLockFile(dataPath(LOCK_FILE_NAME)));
+    dataLock->setStaleLockTime(0);
+    if(dataLock->tryLock()) return true;
+    dataLock.reset();
+    error = "The data in " + QDir(dataPath(".")).absolutePath() + " is in use by another process (another desktop instance or medstore-server)";
+    return false;
+}
+
+// Waits out an openAsync() that has not been delivered yet and drops it
+void StoreCore::abandonLoad() {
+    if(!loader) return;
+    loader->waitForFinished();
+    delete loader;
+    loader = nullptr;
+    delete loadingJournal;
+    loadingJournal = nullptr;
+}
+
+InventoryJournal *StoreCore::beginOpen() {
+    abandonLoad();
+    delete storeJournal;
+    storeJournal = nullptr;
+    return new InventoryJournal(store, dataPath(FILE_NAME));
+}
+
+bool StoreCore::finishOpen(InventoryJournal *journal, InventoryStore &loaded, bool ok, bool salesOk) {
+    emit aboutToReset();
+    if(ok) {
+        store = std::move(loaded);
+        journal->setParent(this);
+        storeJournal = journal;
+        connect(journal, &InventoryJournal::writeFailed, this, &StoreCore::writeFailed);
+    } else {
+        // Stay closed rather than run on a partial store whose journal
+        // would later overwrite the real snapshot
+        store = InventoryStore();
+        delete journal;
+        dataLock.reset();
+    }
+    emit reset();
+    if(!ok) error = "Cannot read the inventory";
+    else if(!salesOk) error = "Cannot open the sales ledger or the receipt archive";
+    return salesOk && ok;
+}
+
+bool StoreCore::open() {
+    if(!lockData()) return false;
+    InventoryJournal *journal = beginOpen();
+    InventoryStore loaded;
+    bool ok = journal->load(loaded, dataPath(LEGACY_FILE_NAME));
+    bool salesOk = sales.open() && receipts.open();
+    return finishOpen(journal, loaded, ok, salesOk);
+}
+
+void StoreCore::openAsync() {
+    if(!lockData()) {
+        QMetaObject::invokeMethod(this, [this]() { emit opened(false); }, Qt::QueuedConnection);
+        return;
+    }
+    // The journal only touches its files while loading; it is parented
+    // and starts committing once it is back on this thread.
+    InventoryJournal *journal = beginOpen();
+    struct Loaded { InventoryStore store; bool ok; bool salesOk; };
+    auto *watcher = new QFutureWatcher<std::shared_ptr<Loaded>>(this);
+    loader = watcher;
+    loadingJournal = journal;
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, journal]() {
+        std::shared_ptr<Loaded> result = watcher->result();
+        watcher->deleteLater();
+        loader = nullptr;
+        loadingJournal = nullptr;
+        emit opened(finishOpen(journal, result->store, result->ok, result->salesOk));
+    });
+    const QString legacy = dataPath(LEGACY_FILE_NAME);
+    watcher->setFuture(QtConcurrent::run([journal, legacy, ledger = &sales, archive = &receipts]() {
+        auto result = std::make_shared<Loaded>();
+        result->ok = journal->load(result->store, legacy);
+        result->salesOk = ledger->open() && archive->open();
+        return result;
+    }));
+}
+
+void StoreCore::close() {
+    closeData();
+    dataLock.reset();
+}
+
+void StoreCore::closeData() {
+    abandonLoad();
+    clearCart();
+    if(!parked.isEmpty()) {
+        parked.clear();
+        emit parkedChanged();
+    }
+    delete storeJournal;
+    storeJournal = nullptr;
+    sales.close();
+    receipts.close();
+}
+
+static void removePath(const QString &path) {
+    if(QFileInfo(path).isDir()) QDir(path).removeRecursively();
+    else QFile::remove(path);
+}
+
+bool StoreCore::replaceData(const QString &dir) {
+    if(!storeJournal) { error = "The data is not open"; return false; }
+    QStringList live = {storeJournal->snapshotPath(), storeJournal->journalPath(), storeJournal->sealedPath()};
+    QStringList incoming = QDir(dir).entryList(QDir::Files);
+    // The ledger and receipts are replaced only by a backup that has them
+    for(const char *sub : {SALES_DIR, RECEIPTS_DIR}) {
+        if(!QFileInfo(dir + "/" + sub).isDir()) continue;
+        live.append(dataPath(sub));
+        incoming.append(sub);
+    }
+    closeData();
+
+    // The live files are set aside first so a failed move can be undone
+    bool moved = true;
+    for(const QString &path : live) {
+        removePath(path + ".old");
+        if(QFileInfo::exists(path) && !QDir().rename(path, path + ".old")) moved = false;
+    }
+    for(const QString &name : incoming) {
+        if(moved && !QDir().rename(dir + "/" + name, dataPath(name))) moved = false;
+    }
+    for(const QString &path : live) {
+        if(moved) {
+            removePath(path + ".old");
+        } else if(QFileInfo::exists(path + ".old")) {
+            removePath(path);
+            QDir().rename(path + ".old", path);
+        }
+    }
+
+    bool opened = open();
+    if(!moved) {
+        error = "Cannot replace the data files in " + QDir(dataPath(".")).absolutePath();
+        return false;
+    }
+    return opened;
+}
+
+bool StoreCore::flush() {
+    if(loader) return true; // the ledger is still being opened on the loader
+    Profiler::ScopedTimer timer(Profiler::StoreFlush);
+    // The journal reports its own failures through writeFailed()
+    if(storeJournal && !storeJournal->flush()) {
+        error = "Cannot write the inventory journal";
+        return false;
+    }
+    if(!sales.commit() || !receipts.commit()) {
+        error = "Cannot write the sales ledger or the receipt archive";
+        emit writeFailed(error);
+        return false;
+    }
+    return true;
+}
+
+// --- INVENTORY ---
+StoreCore::Result StoreCore::addMedicine(const Medicine &m) {
+    if(!storeJournal) return NotReady;
+    if(store.contains(m.id)) return DuplicateId;
+    int slot = store.size();
+    emit aboutToInsert(slot);
+    store.insert(m);
+    emit inserted(slot);
+    storeJournal->appendPut(m);
+    return Ok;
+}
+
+StoreCore::Result StoreCore::updateMedicine(const Medicine &m) {
+    if(!storeJournal) return NotReady;
+    const auto old = store.find(m.id);
+    if(!old) return NotFound;
+
+    // A record without lots (the edit form) keeps the existing lots: added
+    // stock becomes a new lot on the given expiry, removed stock is taken
+    // first-expiry-first-out, and a lone lot can simply be re-dated. With
+    // several lots there is no telling which one a new date is for, so
+    // that is refused (InvalidInput) rather than dropped; such records are
+    // re-dated per lot through the CSV lots column.
+    Medicine next = m;
+    if(next.lots.isEmpty()) {
+        int delta = m.stock - old->stock;
+        if(delta <= 0 && m.expiry != old->expiry && old->lots.size() > 1) return InvalidInput;
+        next.lots = old->lots;
+        if(delta > 0) next.lots.append({m.expiry, delta});
+        else if(delta < 0) next.takeFefo(-delta);
+        if(delta <= 0 && m.expiry != old->expiry && next.lots.size() == 1) next.lots[0].expiry = m.expiry;
+    }
+    store.update(next);
+    int slot = store.slotOf(m.id);
+    emit changed(slot);
+    storeJournal->appendPut(store.at(slot));
+    return Ok;
+}
+
+StoreCore::Result StoreCore::removeMedicine(int id) {
+    if(!storeJournal) return NotReady;
+    if(!store.contains(id)) return NotFound;
+    emit aboutToRemove(store.slotOf(id), store.size() - 1);
+    int moved = store.remove(id);
+    emit removed(moved);
+    storeJournal->appendDelete(id);
+    return Ok;
+}
+
+int StoreCore::importMedicines(const QVector<Medicine> &list) {
+    if(!storeJournal) return 0;
+    Profiler::ScopedTimer timer(Profiler::StoreImport);
+    int added = 0;
+    emit aboutToReset();
+    store.reserve(store.size() + list.size());
+    for(const auto &m : list) {
+        if(store.insert(m)) ++added;
+        else store.update(m);
+    }
+    emit reset();
+    if(!storeJournal->checkpoint()) {
+        // A backup holds the snapshot; journal the records instead
+        for(const auto &m : list) storeJournal->appendPut(store.at(store.slotOf(m.id)));
+    }
+    return added;
+}
+
+void StoreCore::takeStock(int id, int qty) {
+    if(store.takeStock(id, qty) == 0) return;
+    int slot = store.slotOf(id);
+    emit changed(slot);
+    storeJournal->appendPut(store.at(slot));
+}
+
+QVector<InventoryStore::ExpiringLot> StoreCore::expiringWithin(int days) const {
+    return store.expiringBy(packDate(QDate::currentDate().addDays(days)));
+}
+
+// --- CART ---
+int StoreCore::heldQuantity(int id) const {
+    int qty = current.quantityOf(id);
+    for(const auto &p : parked) qty += p.cart.quantityOf(id);
+    return qty;
+}
+
+StoreCore::Result StoreCore::addToCart(int id, int qty) {
+    if(qty <= 0) return InvalidInput;
+    if(!storeJournal) return NotReady;
+    int slot = store.slotOf(id);
+    if(slot < 0) return NotFound;
+    return addSlotToCart(slot, qty);
+}
+
+StoreCore::Result StoreCore::addSlotToCart(int slot, int qty) {
+    if(qty <= 0) return InvalidInput;
+    if(!storeJournal) return NotReady;
+    if(slot < 0 || slot >= store.size()) return NotFound;
+    Profiler::ScopedTimer timer(Profiler::CartAdd);
+    const int id = store.idAt(slot);
+    if(qty + heldQuantity(id) > store.stockAt(slot)) return OutOfStock;
+
+    bool created;
+    int row = current.add(id, store.nameAt(slot), toPaisa(store.priceAt(slot)), qty, &created);
+    if(created) emit cartLineAdded(row);
+    else emit cartLineChanged(row);
+    return Ok;
+}
+
+void StoreCore::removeCartLine(int row) {
+    if(row < 0 || row >= current.size()) return;
+    current.removeAt(row);
+    emit cartLineRemoved(row);
+}
+
+void StoreCore::clearCart() {
+    if(current.isEmpty()) return;
+    current.clear();
+    emit cartChanged();
+}
+
+StoreCore::Result StoreCore::checkout(Sale *sale) {
+    if(current.isEmpty()) return EmptyCart;
+    Profiler::ScopedTimer timer(Profiler::Checkout);
+    Result r = recordSale(current.lines(), sale);
+    if(r != Ok) return r;
+    // A failed commit is retried by the next flush()
+    if(!sales.commit() || !receipts.commit()) {
+        error = "Cannot write the sales ledger or the receipt archive";
+        emit writeFailed(error);
+    }
+    current.clear();
+    emit cartChanged();
+    return Ok;
+}
+
+// --- PARKED CARTS ---
+StoreCore::Result StoreCore::parkCart(const QString &label) {
+    if(current.isEmpty()) return EmptyCart;
+    ParkedCart p;
+    p.label = label.isEmpty() ? "Customer " + QString::number(++parkedCount) : label;
+    p.parkedAt = QDateTime::currentDateTime();
+    p.cart.swap(current);
+    parked.append(p);
+    emit cartChanged();
+    emit parkedChanged();
+    return Ok;
+}
+
+StoreCore::Result StoreCore::resumeCart(int index) {
+    if(index < 0 || index >= parked.size()) return NotFound;
+    ParkedCart resumed = parked.takeAt(index);
+    if(!current.isEmpty()) parkCart();
+    current.swap(resumed.cart);
+    emit cartChanged();
+    emit parkedChanged();
+    return Ok;
+}
+
+StoreCore::Result StoreCore::discardParkedCart(int index) {
+    if(index < 0 || index >= parked.size()) return NotFound;
+    parked.removeAt(index);
+    emit parkedChanged();
+    return Ok;
+}
+
+StoreCore::Result StoreCore::recordSale(const QVector<CartItem> &lines, Sale *sale) {
+    if(lines.isEmpty()) return EmptyCart;
+    if(!storeJournal) return NotReady;
+    QHash<int, int> wanted;
+    for(const auto &c : lines) {
+        if(c.qty <= 0) return InvalidInput;
+        wanted[c.medId] += c.qty;
+    }
+    for(auto it = wanted.cbegin(); it != wanted.cend(); ++it) {
+        int slot = store.slotOf(it.key());
+        if(slot < 0) return NotFound;
+        if(it.value() > store.stockAt(slot)) return OutOfStock;
+    }
+
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 ts = now.toMSecsSinceEpoch();
+    qint64 total = 0;
+    // Stock leaves first-expiry-first-out, so the oldest lot is sold first
+    for(const auto &c : lines) {
+        sales.append(ts, c.medId, c.qty, c.unitPaisa);
+        takeStock(c.medId, c.qty);
+        total += c.lineTotal();
+    }
+    Profiler::count(Profiler::SaleLines, lines.size());
+
+    Receipt receipt;
+    receipt.time = now;
+    receipt.lines = lines;
+    receipt.totalPaisa = total;
+    receipts.append(receipt);
+    if(sale) *sale = receipt;
+    return Ok;
+}
@@ -0,0 +1,157 @@
+#ifndef STORECORE_H
+#define STORECORE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QVector>
+#include <QLockFile>
+#include <memory>
+#include "medicine.h"
+#include "cart.h"
+#include "inventorystore.h"
+#include "inventoryjournal.h"
+#include "salesledger.h"
+#include "receiptarchive.h"
+
+class QFutureWatcherBase;
+
+// --- STORE CORE ---
+// GUI-free inventory, cart and checkout logic shared by the desktop app
+// and the command-line tools. It owns the records, the journal, the
+// sales ledger and the receipt archive. Views follow changes through the about-to/done signal
+// pairs, which are emitted synchronously around every structural change
+// so a QAbstractItemModel can forward them unchanged.
+//
+// open() takes a lock file in the data directory, so a second process
+// (another desktop instance or the checkout server) cannot load the same
+// data and overwrite it.
+class StoreCore : public QObject {
+    Q_OBJECT
+
+public:
+    // NotReady: the data is not open (or still loading, see openAsync())
+    enum Result { Ok, InvalidInput, DuplicateId, NotFound, OutOfStock, EmptyCart, NotReady };
+
+    // Numbered by the receipt archive
+    using Sale = Receipt;
+
+    struct ParkedCart {
+        QString label;
+        QDateTime parkedAt;
+        Cart cart;
+    };
+
+    explicit StoreCore(const QString &dataDir = QString(), QObject *parent = nullptr);
+    ~StoreCore();
+
+    // open() may be called again after close() to reload from disk
+    bool open();
+    // Like open(), but reads the snapshot, journal and ledger on a worker
+    // thread and emits opened() when the data is in place. Until then the
+    // store is empty and inventory changes return NotReady.
+    void openAsync();
+    bool isOpen() const { return storeJournal != nullptr; }
+    void close();
+    // Swaps the inventory files for those in 'dir' (say, a verified
+    // restore), and the sales/ and receipts/ directories when 'dir' has
+    // them, and reopens, holding the data lock throughout so no other
+    // process can open the data mid-swap. Carts are discarded. If a file
+    // cannot be moved, the old ones are put back and reopened instead.
+    bool replaceData(const QString &dir);
+    // Commits the journal, the ledger and the receipt archive. False (see
+    // errorString()) if any of them could not be written; what was not
+    // written is kept and retried on the next flush.
+    bool flush();
+    QString errorString() const { return error; }
+    // Items loaded undated from old files; see InventoryJournal::unreadableExpiries()
+    QStringList unreadableExpiries() const { return storeJournal ? storeJournal->unreadableExpiries() : QStringList(); }
+
+    const InventoryStore &inventory() const { return store; }
+    InventoryJournal *journal() const { return storeJournal; }
+    const SalesLedger &ledger() const { return sales; }
+    const ReceiptArchive &receiptArchive() const { return receipts; }
+    QString dataPath(const QString &name) const;
+
+    // --- INVENTORY ---
+    Result addMedicine(const Medicine &m);
+    Result updateMedicine(const Medicine &m);
+    Result removeMedicine(int id);
+    // Upserts every record and commits them as one new snapshot instead
+    // of one journal record per row (journal records only when the
+    // snapshot cannot be written, e.g. during a backup). Returns the
+    // number of records added.
+    int importMedicines(const QVector<Medicine> &list);
+    // Dated lots expiring within 'days' from today (already expired ones
+    // included), soonest first
+    QVector<InventoryStore::ExpiringLot> expiringWithin(int days) const;
+
+    // --- CART ---
+    const Cart &cart() const { return current; }
+    int quantityInCart(int id) const { return current.quantityOf(id); }
+    qint64 cartTotal() const { return current.total(); }
+    Result addToCart(int id, int qty);
+    // Same, for a caller that has already resolved the id with slotOf()
+    Result addSlotToCart(int slot, int qty);
+    void removeCartLine(int row);
+    void clearCart();
+    Result checkout(Sale *sale = nullptr);
+    // Sells 'lines' directly, bypassing the cart: all lines or none. The
+    // sale reaches disk on the next flush(), so callers can batch them.
+    Result recordSale(const QVector<CartItem> &lines, Sale *sale = nullptr);
+
+    // --- PARKED CARTS ---
+    // A parked cart keeps its quantities held against stock, so it can
+    // always be resumed and checked out while other customers are served.
+    const QVector<ParkedCart> &parkedCarts() const { return parked; }
+    Result parkCart(const QString &label = QString());
+    // A non-empty current cart is parked in the resumed cart's place
+    Result resumeCart(int index);
+    Result discardParkedCart(int index);
+
+signals:
+    void opened(bool ok);
+    // Journal, ledger or receipt archive writes failed (disk full, I/O
+    // error); acknowledged changes are not on disk yet
+    void writeFailed(const QString &message);
+    void aboutToInsert(int slot);
+    void inserted(int slot);
+    // A delete drops the last slot and refills 'slot' from it (swap-remove)
+    void aboutToRemove(int slot, int lastSlot);
+    void removed(int refilledSlot);
+    void changed(int slot);
+    void aboutToReset();
+    void reset();
+    // Single-line cart changes; everything else (clear, checkout, park,
+    // resume) is a cartChanged() and should be treated as a reset
+    void cartLineAdded(int row);
+    void cartLineChanged(int row);
+    void cartLineRemoved(int row);
+    void cartChanged();
+    void parkedChanged();
+
+private:
+    QString dir;
+    QString error;
+    std::unique_ptr<QLockFile> dataLock;
+    InventoryStore store;
+    InventoryJournal *storeJournal = nullptr;
+    QFutureWatcherBase *loader = nullptr;
+    InventoryJournal *loadingJournal = nullptr;
+    SalesLedger sales;
+    ReceiptArchive receipts;
+    Cart current;
+    QVector<ParkedCart> parked;
+    int parkedCount = 0;
+
+    void takeStock(int id, int qty);
+    bool lockData();
+    void abandonLoad();
+    // close() without giving up the data lock
+    void closeData();
+    InventoryJournal *beginOpen();
+    bool finishOpen(InventoryJournal *journal, InventoryStore &loaded, bool ok, bool salesOk);
+    // Quantity of 'id' in the current and all parked carts
+    int heldQuantity(int id) const;
+};
+
+#endif // STORECORE_H
@@ -0,0 +1,72 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QTimer>
+#include <csignal>
+
+#include "storecore.h"
+#include "checkoutserver.h"
+#include "profiler.h"
+
+static QTextStream &out() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+// Set by SIGINT/SIGTERM. No Qt call is safe inside a signal handler, so
+// the event loop polls it and quits, which closes the server cleanly.
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) { stopRequested = 1; }
+
+// Prints the profile and writes the trace requested on the command line
+static void finishProfile(const QCommandLineParser &parser) {
+    if(!Profiler::isEnabled()) return;
+    out() << "\n" << Profiler::report();
+    if(parser.isSet("trace") && !Profiler::writeTrace(parser.value("trace"))) out() << "Cannot write " << parser.value("trace") << "\n";
+    out().flush();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("medstore-server");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Medical Store checkout server for multiple billing counters");
+    parser.addHelpOption();
+    parser.addOption({{"d", "data-dir"}, "Directory holding medicines.inv and sales/.", "dir", "."});
+    parser.addOption({{"n", "name"}, "Local server name the counters connect to.", "name", "medstore"});
+    parser.addOption({{"w", "workers"}, "Connection worker threads (0 = one per core).", "count", "0"});
+    parser.addOption({"profile", "Print latency percentiles of the instrumented paths on exit."});
+    parser.addOption({"trace", "Record spans and write them as Chrome trace-event JSON on exit.", "file"});
+    parser.process(app);
+    if(parser.isSet("trace")) Profiler::setTracing(true);
+    else if(parser.isSet("profile")) Profiler::setEnabled(true);
+
+    StoreCore core(parser.value("data-dir"));
+    if(!core.open()) {
+        out() << "Cannot open data in " << parser.value("data-dir") << ": " << core.errorString() << Qt::endl;
+        return 1;
+    }
+    for(const QString &item : core.unreadableExpiries()) out() << "Loaded without expiry (old date unreadable): " << item << Qt::endl;
+
+    QObject::connect(&core, &StoreCore::writeFailed, &app, [](const QString &message) { out() << message << Qt::endl; });
+
+    CheckoutServer server(core);
+    if(!server.listen(parser.value("name"), parser.value("workers").toInt())) {
+        out() << "Cannot listen on " << parser.value("name") << ": " << server.errorString() << Qt::endl;
+        return 1;
+    }
+    out() << "Serving " << core.inventory().size() << " medicines on '" << parser.value("name") << "'" << Qt::endl;
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &server, &CheckoutServer::close);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    QTimer stopPoll;
+    QObject::connect(&stopPoll, &QTimer::timeout, &app, []() { if(stopRequested) QCoreApplication::quit(); });
+    stopPoll.start(100);
+    int rc = app.exec();
+    core.close();
+    finishProfile(parser);
+    return rc;
+}
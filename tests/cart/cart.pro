@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_cart
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_cart.cpp
+
+include(../../core/core.pri)
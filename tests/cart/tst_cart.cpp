@@ -0,0 +1,102 @@
+#include <QtTest>
+#include "cart.h"
+
+// --- CART TESTS ---
+class CartTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void totalsAreExact();
+    void editsKeepTotal();
+    void rupeeText_data();
+    void rupeeText();
+    void takeFefo();
+};
+
+void CartTest::totalsAreExact() {
+    Cart cart;
+    bool created = false;
+    QCOMPARE(cart.add(1, "A", toPaisa(0.1), 1, &created), 0);
+    QVERIFY(created);
+    QCOMPARE(cart.add(2, "B", toPaisa(0.2), 1, &created), 1);
+    QCOMPARE(cart.total(), qint64(30));
+    QCOMPARE(cart.add(1, "A", toPaisa(0.1), 2, &created), 0);
+    QVERIFY(!created);
+    QCOMPARE(cart.quantityOf(1), 3);
+    QCOMPARE(cart.total(), qint64(50));
+
+    // A thousand 10-paisa items make exactly Rs 100
+    Cart many;
+    for(int i=0; i<1000; ++i) many.add(i, "X", toPaisa(0.1), 1);
+    QCOMPARE(many.total(), qint64(10000));
+    QCOMPARE(formatRupees(many.total()), QString("100.00"));
+}
+
+void CartTest::editsKeepTotal() {
+    Cart cart;
+    cart.add(10, "A", 1250, 2);
+    cart.add(20, "B", 399, 1);
+    cart.add(30, "C", 5, 10);
+    QCOMPARE(cart.total(), qint64(2500 + 399 + 50));
+
+    cart.setQuantity(0, 5);
+    QCOMPARE(cart.total(), qint64(6250 + 399 + 50));
+    cart.removeAt(1);
+    QCOMPARE(cart.size(), 2);
+    QCOMPARE(cart.rowOf(20), -1);
+    QCOMPARE(cart.rowOf(30), 1);
+    QCOMPARE(cart.total(), qint64(6250 + 50));
+    cart.setQuantity(1, 0);
+    QCOMPARE(cart.size(), 1);
+    QCOMPARE(cart.total(), qint64(6250));
+
+    Cart parked;
+    parked.swap(cart);
+    QVERIFY(cart.isEmpty());
+    QCOMPARE(cart.total(), qint64(0));
+    QCOMPARE(parked.total(), qint64(6250));
+    parked.clear();
+    QCOMPARE(parked.total(), qint64(0));
+}
+
+void CartTest::rupeeText_data() {
+    QTest::addColumn<qint64>("paisa");
+    QTest::addColumn<QString>("text");
+    QTest::newRow("zero") << qint64(0) << "0.00";
+    QTest::newRow("paisa") << qint64(5) << "0.05";
+    QTest::newRow("rupees") << qint64(12345) << "123.45";
+    QTest::newRow("negative") << qint64(-250) << "-2.50";
+}
+
+void CartTest::rupeeText() {
+    QFETCH(qint64, paisa);
+    QFETCH(QString, text);
+    QCOMPARE(formatRupees(paisa), text);
+}
+
+void CartTest::takeFefo() {
+    const PackedDate jan = packDate(QDate(2027, 1, 31));
+    const PackedDate mar = packDate(QDate(2027, 3, 31));
+    Medicine m;
+    m.lots = {{0, 10}, {mar, 5}, {jan, 4}};
+    m.normalizeLots();
+    QCOMPARE(m.stock, 19);
+    QCOMPARE(m.expiry, jan);
+
+    QCOMPARE(m.takeFefo(6), 6);
+    QCOMPARE(m.lots.size(), 2);
+    QCOMPARE(m.lots[0].expiry, mar);
+    QCOMPARE(m.lots[0].qty, 3);
+    QCOMPARE(m.lots[1].expiry, PackedDate(0));
+    QCOMPARE(m.lots[1].qty, 10);
+    QCOMPARE(m.stock, 13);
+    QCOMPARE(m.expiry, mar);
+
+    // Undated stock goes last, and no more than there is
+    QCOMPARE(m.takeFefo(20), 13);
+    QVERIFY(m.lots.isEmpty());
+    QCOMPARE(m.stock, 0);
+}
+
+QTEST_GUILESS_MAIN(CartTest)
+#include "tst_cart.moc"
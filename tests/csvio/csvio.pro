@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_csvio
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_csvio.cpp
+
+include(../../core/core.pri)
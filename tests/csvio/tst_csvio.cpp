@@ -0,0 +1,108 @@
+#include <QtTest>
+#include "csvio.h"
+
+// --- CSV TESTS ---
+class CsvTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void quoteRoundTrip_data();
+    void quoteRoundTrip();
+    void medicineRoundTrip();
+    void badExpiryRejected_data();
+    void badExpiryRejected();
+    void parseParallelCountsRejected();
+};
+
+void CsvTest::quoteRoundTrip_data() {
+    QTest::addColumn<QString>("field");
+    QTest::newRow("plain") << "Paracetamol";
+    QTest::newRow("empty") << "";
+    QTest::newRow("comma") << "Cough syrup, 100ml";
+    QTest::newRow("quote") << "5\" bandage";
+    QTest::newRow("only quotes") << "\"\"";
+    QTest::newRow("leading space") << "  Zinc";
+    QTest::newRow("trailing space") << "Zinc  ";
+    QTest::newRow("padded comma") << " a, b ";
+    QTest::newRow("unicode") << QString::fromUtf8("\xE0\xA4\x85\xE0\xA4\xAE\xE0\xA5\x83\xE0\xA4\xA4");
+}
+
+void CsvTest::quoteRoundTrip() {
+    QFETCH(QString, field);
+    const QString line = CsvIO::quote("x") + "," + CsvIO::quote(field) + "," + CsvIO::quote(field);
+    const QStringList fields = CsvIO::splitLine(line);
+    QCOMPARE(fields.size(), 3);
+    QCOMPARE(fields[0], QString("x"));
+    QCOMPARE(fields[1], field);
+    QCOMPARE(fields[2], field);
+}
+
+void CsvTest::medicineRoundTrip() {
+    Medicine m;
+    m.id = 42;
+    m.name = " Vitamin \"D3\", 1000 IU ";
+    m.price = 99.75;
+    m.company = "Sun Pharma";
+    m.lots = {{packDate(QDate(2027, 3, 31)), 5}, {0, 2}, {packDate(QDate(2026, 12, 31)), 8}};
+    m.reorderLevel = 6;
+    m.normalizeLots();
+
+    Medicine parsed;
+    QVERIFY(CsvIO::parseMedicine(CsvIO::formatMedicine(m), parsed));
+    QCOMPARE(parsed.id, m.id);
+    QCOMPARE(parsed.name, m.name);
+    QCOMPARE(parsed.price, m.price);
+    QCOMPARE(parsed.stock, 15);
+    QCOMPARE(parsed.expiry, packDate(QDate(2026, 12, 31)));
+    QCOMPARE(parsed.company, m.company);
+    QCOMPARE(parsed.reorderLevel, 6);
+    QCOMPARE(parsed.lots.size(), 3);
+    QCOMPARE(parsed.lots.last().expiry, PackedDate(0));
+    QCOMPARE(parsed.lots.last().qty, 2);
+
+    // Short form: no lots or reorder column, month-only expiry
+    QVERIFY(CsvIO::parseMedicine("7, Aspirin ,1.5,30,2027-02,Bayer", parsed));
+    QCOMPARE(parsed.name, QString("Aspirin"));
+    QCOMPARE(parsed.expiry, packDate(QDate(2027, 2, 28)));
+    QCOMPARE(parsed.stock, 30);
+    QCOMPARE(parsed.reorderLevel, int(Medicine::DEFAULT_REORDER_LEVEL));
+}
+
+void CsvTest::badExpiryRejected_data() {
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<bool>("accepted");
+    QTest::newRow("undated") << "1,Gauze,2,5,,Acme" << true;
+    QTest::newRow("bad expiry") << "1,Gauze,2,5,soon,Acme" << false;
+    QTest::newRow("bad date") << "1,Gauze,2,5,2027-02-30,Acme" << false;
+    QTest::newRow("undated lot") << "1,Gauze,2,0,,Acme,:3" << true;
+    QTest::newRow("bad lot expiry") << "1,Gauze,2,0,,Acme,2027-01-31:3;later:2" << false;
+    QTest::newRow("bad lot qty") << "1,Gauze,2,0,,Acme,2027-01-31:x" << false;
+    QTest::newRow("bad reorder") << "1,Gauze,2,5,,Acme,,-1" << false;
+    QTest::newRow("too few fields") << "1,Gauze,2,5,2027-01-31" << false;
+}
+
+void CsvTest::badExpiryRejected() {
+    QFETCH(QString, line);
+    QFETCH(bool, accepted);
+    Medicine m;
+    QCOMPARE(CsvIO::parseMedicine(line, m), accepted);
+}
+
+void CsvTest::parseParallelCountsRejected() {
+    QStringList lines;
+    for(int i=1; i<=1000; ++i) {
+        if(i % 100 == 0) lines << QString("%1,Bad,1,1,never,Acme").arg(i);
+        else lines << QString("%1,Item %1,1.25,%1,2027-01-31,Acme").arg(i);
+    }
+    lines << "" << "   ";
+    int rejected = -1;
+    const QVector<Medicine> parsed = CsvIO::parseParallel(lines, &rejected);
+    QCOMPARE(rejected, 10);
+    QCOMPARE(parsed.size(), 990);
+    // Order is kept across slices
+    QCOMPARE(parsed.first().id, 1);
+    QCOMPARE(parsed.last().id, 999);
+}
+
+QTEST_GUILESS_MAIN(CsvTest)
+#include "tst_csvio.moc"
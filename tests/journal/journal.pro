@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_journal
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_journal.cpp
+
+include(../../core/core.pri)
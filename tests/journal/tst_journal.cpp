@@ -0,0 +1,187 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include "inventoryfile.h"
+#include "inventoryjournal.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#include <csignal>
+#endif
+
+static Medicine makeMedicine(int id, const QString &name, const QString &company, int stock) {
+    Medicine m;
+    m.id = id;
+    m.name = name;
+    m.price = 12.5;
+    m.stock = stock;
+    m.expiry = packDate(QDate(2027, 6, 30));
+    m.company = company;
+    m.normalizeLots();
+    return m;
+}
+
+// --- JOURNAL TESTS ---
+class JournalTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void journalReplay();
+    void tornTailIsTruncated();
+    void sealedJournalRecovered();
+    void failedWriteIsRetried();
+};
+
+void JournalTest::journalReplay() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("inventory.msiv");
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store));
+        for(int id=1; id<=3; ++id) {
+            store.insert(makeMedicine(id, QString("Item %1").arg(id), "Acme", 20));
+            journal.appendPut(*store.find(id));
+        }
+        QCOMPARE(store.takeStock(2, 15), 15);
+        journal.appendPut(*store.find(2));
+        store.remove(3);
+        journal.appendDelete(3);
+        journal.flush();
+    }
+    QVERIFY(!QFile::exists(path));
+    QVERIFY(QFile(path + ".journal").size() > 0);
+
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(journal.load(store));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.find(1)->stock, 20);
+    QCOMPARE(store.find(2)->stock, 5);
+    QVERIFY(!store.contains(3));
+}
+
+void JournalTest::tornTailIsTruncated() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("inventory.msiv");
+    const QString journalPath = path + ".journal";
+    qint64 good = 0;
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store));
+        store.insert(makeMedicine(1, "Cetirizine", "Acme", 8));
+        journal.appendPut(*store.find(1));
+        journal.flush();
+        good = QFile(journalPath).size();
+    }
+    // A record cut short by a crash: a header promising more than follows
+    QFile file(journalPath);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(QByteArray("\x40\x00\x00\x00\x12\x34\x56\x78\x04\x01\x02", 11));
+    file.close();
+
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store));
+        QCOMPARE(store.size(), 1);
+        QCOMPARE(QFile(journalPath).size(), good);
+        // New records must follow the last good one, not the junk
+        store.insert(makeMedicine(2, "Ibuprofen", "Acme", 4));
+        journal.appendPut(*store.find(2));
+        journal.flush();
+    }
+
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(journal.load(store));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.find(2)->stock, 4);
+}
+
+void JournalTest::sealedJournalRecovered() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("inventory.msiv");
+    // Records written under another name, then sealed as if a compaction
+    // had stopped half way
+    const QString other = dir.filePath("other.msiv");
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, other);
+        QVERIFY(journal.load(store));
+        store.insert(makeMedicine(7, "Omeprazole", "Zydus", 12));
+        journal.appendPut(*store.find(7));
+        journal.flush();
+    }
+    QVERIFY(QFile::rename(other + ".journal", path + ".journal.sealed"));
+
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store));
+        QCOMPARE(store.size(), 1);
+        QCOMPARE(store.find(7)->stock, 12);
+        QVERIFY(!QFile::exists(journal.sealedPath()));
+        QVERIFY(QFile::exists(path));
+    }
+
+    // The record now lives in the snapshot itself
+    InventoryStore store;
+    QVERIFY(InventoryFile::read(path, store));
+    QCOMPARE(store.size(), 1);
+    QCOMPARE(store.find(7)->name, QString("Omeprazole"));
+}
+
+void JournalTest::failedWriteIsRetried() {
+#ifndef Q_OS_UNIX
+    QSKIP("Needs RLIMIT_FSIZE to make writes fail");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("inventory.msiv");
+    const QString journalPath = path + ".journal";
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store));
+        store.insert(makeMedicine(1, "Cetirizine", "Acme", 8));
+        journal.appendPut(*store.find(1));
+        QVERIFY(journal.flush());
+        const qint64 good = QFile(journalPath).size();
+
+        // Let the journal grow by a few bytes only, as on a full disk
+        QSignalSpy failures(&journal, &InventoryJournal::writeFailed);
+        rlimit saved;
+        QCOMPARE(getrlimit(RLIMIT_FSIZE, &saved), 0);
+        rlimit limited = saved;
+        limited.rlim_cur = rlim_t(good + 10);
+        auto handler = std::signal(SIGXFSZ, SIG_IGN);
+        QCOMPARE(setrlimit(RLIMIT_FSIZE, &limited), 0);
+        store.insert(makeMedicine(2, QString(100, 'x'), "Acme", 4));
+        journal.appendPut(*store.find(2));
+        const bool flushed = journal.flush();
+        setrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, handler);
+
+        QVERIFY(!flushed);
+        QCOMPARE(failures.count(), 1);
+        QCOMPARE(QFile(journalPath).size(), good);
+        // The record was kept and goes out with the next flush
+        QVERIFY(journal.flush());
+        QVERIFY(QFile(journalPath).size() > good);
+    }
+
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(journal.load(store));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.find(2)->name, QString(100, 'x'));
+#endif
+}
+
+QTEST_GUILESS_MAIN(JournalTest)
+#include "tst_journal.moc"
@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_receipt
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_receipt.cpp
+
+include(../../core/core.pri)
@@ -0,0 +1,114 @@
+#include <QtTest>
+#include "receipt.h"
+
+static Receipt sampleReceipt() {
+    Receipt r;
+    r.number = 7;
+    r.time = QDateTime(QDate(2026, 3, 5), QTime(9, 7));
+    r.lines.append({1, "Paracetamol 500", 250, 2});
+    r.lines.append({2, "Zinc", 1999, 10});
+    r.totalPaisa = 500 + 19990;
+    return r;
+}
+
+// --- RECEIPT TESTS ---
+class ReceiptTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void compileErrors_data();
+    void compileErrors();
+    void render();
+    void renderUnicodeName();
+    void renderDates();
+    void defaultTemplate();
+};
+
+void ReceiptTest::compileErrors_data() {
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<QString>("error");
+    QTest::newRow("valid") << "{{ number }} {{total>9}}{{#lines}}{{name<20}}{{/lines}}" << "";
+    QTest::newRow("unclosed") << "Receipt {{number" << "Unclosed {{ at offset 8";
+    QTest::newRow("nested") << "{{#lines}}{{#lines}}{{/lines}}{{/lines}}" << "{{#lines}} cannot be nested";
+    QTest::newRow("stray close") << "{{/lines}}" << "{{/lines}} without {{#lines}}";
+    QTest::newRow("line field outside") << "{{qty}}" << "{{qty}} is only valid inside {{#lines}}";
+    QTest::newRow("unknown") << "{{#lines}}{{colour}}{{/lines}}" << "Unknown field {{colour}}";
+    QTest::newRow("zero width") << "{{total>0}}" << "Bad width in {{total>0}}";
+    QTest::newRow("wide") << "{{total<256}}" << "Bad width in {{total<256}}";
+    QTest::newRow("no width") << "{{total<}}" << "Bad width in {{total<}}";
+    QTest::newRow("not closed") << "{{#lines}}{{name}}" << "{{#lines}} is not closed";
+}
+
+void ReceiptTest::compileErrors() {
+    QFETCH(QString, source);
+    QFETCH(QString, error);
+    ReceiptTemplate layout(source);
+    QCOMPARE(layout.isValid(), error.isEmpty());
+    QCOMPARE(layout.errorString(), error);
+    if(!layout.isValid()) {
+        // A broken template renders nothing
+        QByteArray out;
+        layout.render(sampleReceipt(), out);
+        QVERIFY(out.isEmpty());
+    }
+}
+
+void ReceiptTest::render() {
+    ReceiptTemplate layout("#{{number>4}} {{date}}\n"
+                           "{{#lines}}{{name<8}}|{{qty>3}}|{{amount>8}}|{{price}}|{{id}}\n{{/lines}}"
+                           "{{items}} items, {{units}} units, Rs {{total}}\n");
+    QVERIFY2(layout.isValid(), qPrintable(layout.errorString()));
+    QByteArray out("prefix\n");
+    layout.render(sampleReceipt(), out);
+    QCOMPARE(out, QByteArray("prefix\n"
+                             "#   7 2026-03-05 09:07\n"
+                             "Paraceta|  2|    5.00|2.50|1\n"
+                             "Zinc    | 10|  199.90|19.99|2\n"
+                             "2 items, 12 units, Rs 204.90\n"));
+}
+
+void ReceiptTest::renderUnicodeName() {
+    // Widths count characters, not UTF-8 bytes
+    Receipt r;
+    r.lines.append({1, QString::fromUtf8("\xE0\xA4\x85\xE0\xA4\xAE\xE0\xA5\x83\xE0\xA4\xA4"), 100, 1});
+    r.lines.append({2, QString::fromUtf8("\xF0\x9F\x92\x8A pills"), 100, 1});
+    ReceiptTemplate layout("{{#lines}}[{{name<6}}][{{name>3}}]\n{{/lines}}");
+    QVERIFY(layout.isValid());
+    QByteArray out;
+    layout.render(r, out);
+    QCOMPARE(out, QByteArray("[\xE0\xA4\x85\xE0\xA4\xAE\xE0\xA5\x83\xE0\xA4\xA4  ][\xE0\xA4\x85\xE0\xA4\xAE\xE0\xA5\x83]\n"
+                             "[\xF0\x9F\x92\x8A pill][\xF0\x9F\x92\x8A p]\n"));
+}
+
+void ReceiptTest::renderDates() {
+    ReceiptTemplate layout("Date: {{date}}|");
+    QVERIFY(layout.isValid());
+    Receipt r;
+    QByteArray out;
+    layout.render(r, out);
+    QCOMPARE(out, QByteArray("Date: |"));
+
+    r.time = QDateTime(QDate(999, 1, 2), QTime(3, 4));
+    out.clear();
+    layout.render(r, out);
+    QCOMPARE(out, QByteArray("Date: 0999-01-02 03:04|"));
+
+    r.time = QDateTime(QDate(2026, 12, 31), QTime(23, 59, 59));
+    out.clear();
+    layout.render(r, out);
+    QCOMPARE(out, QByteArray("Date: 2026-12-31 23:59|"));
+}
+
+void ReceiptTest::defaultTemplate() {
+    ReceiptTemplate layout;
+    QVERIFY2(layout.isValid(), qPrintable(layout.errorString()));
+    QByteArray out;
+    layout.render(sampleReceipt(), out);
+    QVERIFY(out.contains("Receipt: 7\n"));
+    QVERIFY(out.contains("Date: 2026-03-05 09:07\n"));
+    QVERIFY(out.contains("Paracetamol 500   2.50    2    5.00\n"));
+    QVERIFY(out.contains("GRAND TOTAL: Rs 204.90\n"));
+}
+
+QTEST_GUILESS_MAIN(ReceiptTest)
+#include "tst_receipt.moc"
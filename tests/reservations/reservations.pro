@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_reservations
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_reservations.cpp
+
+include(../../core/core.pri)
@@ -0,0 +1,90 @@
+#include <QtTest>
+#include <QThread>
+#include <QAtomicInt>
+#include <memory>
+#include <vector>
+#include "stockreservations.h"
+
+static Medicine makeMedicine(int id, int stock) {
+    Medicine m;
+    m.id = id;
+    m.name = QString("Item %1").arg(id);
+    m.price = 2.5;
+    m.stock = stock;
+    m.normalizeLots();
+    return m;
+}
+
+// --- RESERVATION TESTS ---
+class ReservationsTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void reserveAndRelease();
+    void concurrentReserve();
+};
+
+void ReservationsTest::reserveAndRelease() {
+    InventoryStore store;
+    store.insert(makeMedicine(1, 5));
+    store.insert(makeMedicine(2, 0));
+    StockReservations reservations;
+    reservations.load(store);
+
+    QCOMPARE(reservations.available(99), -1);
+    QVERIFY(!reservations.reserve(99, 1));
+    QVERIFY(!reservations.reserve(2, 1));
+    QCOMPARE(reservations.available(2), 0);
+
+    QVERIFY(reservations.reserve(1, 3));
+    QCOMPARE(reservations.available(1), 2);
+    QVERIFY(!reservations.reserve(1, 3));
+    QCOMPARE(reservations.available(1), 2);
+    QVERIFY(reservations.reserve(1, 2));
+    QCOMPARE(reservations.available(1), 0);
+    reservations.release(1, 4);
+    QCOMPARE(reservations.available(1), 4);
+
+    QString name;
+    qint64 unitPaisa = 0;
+    int available = 0;
+    QVERIFY(reservations.lookup(1, &name, &unitPaisa, &available));
+    QCOMPARE(name, QString("Item 1"));
+    QCOMPARE(unitPaisa, qint64(250));
+    QCOMPARE(available, 4);
+
+    reservations.set(makeMedicine(3, 7), 7);
+    QCOMPARE(reservations.available(3), 7);
+    reservations.remove(3);
+    QVERIFY(!reservations.contains(3));
+    QVERIFY(!reservations.reserve(3, 1));
+}
+
+void ReservationsTest::concurrentReserve() {
+    const int STOCK = 20000;
+    const int THREADS = 8;
+    InventoryStore store;
+    store.insert(makeMedicine(1, STOCK));
+    StockReservations reservations;
+    reservations.load(store);
+
+    // Every counter grabs one unit at a time until it is refused; the
+    // compare-and-swap must neither oversell nor lose a unit
+    QAtomicInt granted;
+    std::vector<std::unique_ptr<QThread>> threads;
+    for(int t=0; t<THREADS; ++t) {
+        threads.emplace_back(QThread::create([&]() {
+            int mine = 0;
+            while(reservations.reserve(1, 1)) ++mine;
+            granted.fetchAndAddOrdered(mine);
+        }));
+        threads.back()->start();
+    }
+    for(auto &thread : threads) QVERIFY(thread->wait(30000));
+
+    QCOMPARE(granted.loadAcquire(), STOCK);
+    QCOMPARE(reservations.available(1), 0);
+}
+
+QTEST_GUILESS_MAIN(ReservationsTest)
+#include "tst_reservations.moc"
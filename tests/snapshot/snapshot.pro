@@ -0,0 +1,8 @@
+QT       = core testlib
+TARGET = tst_snapshot
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+SOURCES += tst_snapshot.cpp
+
+include(../../core/core.pri)
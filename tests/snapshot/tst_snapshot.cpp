@@ -0,0 +1,197 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDataStream>
+#include "inventoryfile.h"
+#include "inventoryjournal.h"
+
+static Medicine makeMedicine(int id, const QString &name, const QString &company, int stock) {
+    Medicine m;
+    m.id = id;
+    m.name = name;
+    m.price = 12.5;
+    m.stock = stock;
+    m.expiry = packDate(QDate(2027, 6, 30));
+    m.company = company;
+    m.normalizeLots();
+    return m;
+}
+
+static void compareMedicine(const Medicine &a, const Medicine &b) {
+    QCOMPARE(a.id, b.id);
+    QCOMPARE(a.name, b.name);
+    QCOMPARE(a.price, b.price);
+    QCOMPARE(a.stock, b.stock);
+    QCOMPARE(a.expiry, b.expiry);
+    QCOMPARE(a.company, b.company);
+    QCOMPARE(a.reorderLevel, b.reorderLevel);
+    QCOMPARE(a.lots.size(), b.lots.size());
+    for(int i=0; i<a.lots.size(); ++i) {
+        QCOMPARE(a.lots[i].expiry, b.lots[i].expiry);
+        QCOMPARE(a.lots[i].qty, b.lots[i].qty);
+    }
+}
+
+// medicines.dat as the original version wrote it: a count, then id, name,
+// price, stock, free-text expiry and company per record
+static QByteArray legacyFile(quint32 count, const QString &secondExpiry = "06/2027") {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << count;
+    out << 1 << QString("Paracetamol") << 2.5 << 40 << QString("2026-05-31") << QString("Cipla");
+    out << 2 << QString("Cetirizine") << 1.25 << 15 << secondExpiry << QString("Acme");
+    return data;
+}
+
+static void writeFile(const QString &path, const QByteArray &data) {
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), qint64(data.size()));
+}
+
+static QByteArray readFile(const QString &path) {
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+// --- SNAPSHOT TESTS ---
+class SnapshotTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void snapshotRoundTrip();
+    void unreadableSnapshotIsKept();
+    void legacyIsConverted();
+    void unreadableLegacyExpiryIsReported();
+    void damagedLegacyIsKept_data();
+    void damagedLegacyIsKept();
+};
+
+void SnapshotTest::snapshotRoundTrip() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    InventoryStore store;
+    Medicine multi = makeMedicine(1, "Paracetamol 500mg", "Cipla", 0);
+    multi.lots = {{packDate(QDate(2027, 1, 31)), 4}, {0, 10}, {packDate(QDate(2026, 11, 30)), 7}};
+    multi.reorderLevel = 25;
+    multi.normalizeLots();
+    store.insert(multi);
+    store.insert(makeMedicine(2, QString::fromUtf8("Amoxicillin \xE0\xA4\x85 250mg"), "Cipla", 3));
+    Medicine undated = makeMedicine(3, "Bandage", "", 5);
+    undated.expiry = 0;
+    undated.lots.clear();
+    undated.normalizeLots();
+    store.insert(undated);
+
+    const QString path = dir.filePath("inventory.msiv");
+    QVERIFY(InventoryFile::write(path, store));
+    InventoryStore loaded;
+    QVERIFY(InventoryFile::read(path, loaded));
+    QCOMPARE(loaded.size(), store.size());
+    for(int slot=0; slot<store.size(); ++slot) {
+        const std::optional<Medicine> m = loaded.find(store.idAt(slot));
+        QVERIFY(m.has_value());
+        compareMedicine(*m, store.at(slot));
+    }
+    QCOMPARE(loaded.find(1)->lots.size(), 3);
+    QCOMPARE(loaded.find(1)->expiry, packDate(QDate(2026, 11, 30)));
+}
+
+void SnapshotTest::unreadableSnapshotIsKept() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("inventory.msiv");
+    const QByteArray garbage("not an inventory snapshot");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(garbage);
+    file.close();
+
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(!journal.load(store));
+    QVERIFY(!journal.checkpoint());
+    journal.compactNow();
+    QVERIFY(!journal.isCompacting());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), garbage);
+}
+
+void SnapshotTest::legacyIsConverted() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("medicines.inv");
+    const QString legacy = dir.filePath("medicines.dat");
+    writeFile(legacy, legacyFile(2));
+
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(journal.load(store, legacy));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.find(1)->expiry, packDate(QDate(2026, 5, 31)));
+    QCOMPARE(store.find(2)->expiry, packDate(QDate(2027, 6, 30)));
+    QCOMPARE(store.find(2)->stock, 15);
+    QVERIFY(QFile::exists(path));
+    QVERIFY(QFile::exists(legacy + ".bak"));
+    QVERIFY(!QFile::exists(legacy));
+    QVERIFY(journal.unreadableExpiries().isEmpty());
+}
+
+void SnapshotTest::unreadableLegacyExpiryIsReported() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("medicines.inv");
+    const QString legacy = dir.filePath("medicines.dat");
+    const QByteArray data = legacyFile(2, " Mar 2025 ");
+    writeFile(legacy, data);
+    {
+        InventoryStore store;
+        InventoryJournal journal(store, path);
+        QVERIFY(journal.load(store, legacy));
+        QCOMPARE(store.size(), 2);
+        QCOMPARE(store.find(2)->expiry, PackedDate(0));
+        QCOMPARE(journal.unreadableExpiries(), QStringList("2 Cetirizine: Mar 2025"));
+        // The original stays in place until the dates have been re-entered
+        QVERIFY(QFile::exists(path));
+        QVERIFY(!QFile::exists(legacy + ".bak"));
+        QCOMPARE(readFile(legacy), data);
+    }
+
+    // Later starts use the converted snapshot and report nothing
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(journal.load(store, legacy));
+    QCOMPARE(store.size(), 2);
+    QVERIFY(journal.unreadableExpiries().isEmpty());
+}
+
+void SnapshotTest::damagedLegacyIsKept_data() {
+    QTest::addColumn<QByteArray>("data");
+    const QByteArray whole = legacyFile(2);
+    QTest::newRow("truncated") << whole.left(whole.size() - 5);
+    QTest::newRow("missing record") << legacyFile(3);
+    QTest::newRow("huge count") << legacyFile(0x7FFFFFFF);
+    QTest::newRow("short header") << QByteArray("\x00\x00", 2);
+}
+
+void SnapshotTest::damagedLegacyIsKept() {
+    QFETCH(QByteArray, data);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("medicines.inv");
+    const QString legacy = dir.filePath("medicines.dat");
+    writeFile(legacy, data);
+
+    // Nothing is converted, so the next start sees the same file
+    InventoryStore store;
+    InventoryJournal journal(store, path);
+    QVERIFY(!journal.load(store, legacy));
+    QCOMPARE(store.size(), 0);
+    QVERIFY(!QFile::exists(path));
+    QVERIFY(!QFile::exists(legacy + ".bak"));
+    QCOMPARE(readFile(legacy), data);
+    QVERIFY(!journal.checkpoint());
+}
+
+QTEST_GUILESS_MAIN(SnapshotTest)
+#include "tst_snapshot.moc"
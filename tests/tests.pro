@@ -0,0 +1,2 @@
+TEMPLATE = subdirs
+SUBDIRS = journal snapshot csvio cart reservations receipt